@@ -5,7 +5,7 @@
 #include <sys/wait.h>
 #include <fcntl.h>
 #include <stdlib.h>
-#include <sys/event.h>//for kqueue and kevent
+#include <cstdio> // for perror
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -15,6 +15,39 @@
 namespace CGI{
 
 	CGIHandler::CGIHandler(int port_number){
+		set_default_meta_variables();
+		_meta_variables["SERVER_PORT"] = Utility::to_string(port_number);
+
+		_input_pipe[0] = -1;
+		_input_pipe[1] = -1;
+		_output_pipe[0] = -1;
+		_output_pipe[1] = -1;
+		_request_body_fd = -1;
+
+		_search_cgi_extension = false;
+		_response = "";
+		initialize_cgi_arguments();
+	}
+
+	CGIHandler::~CGIHandler(){
+		close_child_pipe_ends();
+		free_cgi_arguments();
+	}
+
+	/* the ends the child reads and writes, the server owns and closes the other two */
+	void CGIHandler::close_child_pipe_ends() {
+		if (_input_pipe[0] != -1)
+			close(_input_pipe[0]);
+		if (_output_pipe[1] != -1)
+			close(_output_pipe[1]);
+		if (_request_body_fd != -1)
+			close(_request_body_fd);
+		_input_pipe[0] = -1;
+		_output_pipe[1] = -1;
+		_request_body_fd = -1;
+	}
+
+	void CGIHandler::set_default_meta_variables() {
 		_meta_variables["AUTH_TYPE"] = "";
 		_meta_variables["CONTENT_LENGTH"] = "";
 		_meta_variables["CONTENT_TYPE"] = "";
@@ -29,34 +62,42 @@ namespace CGI{
 		_meta_variables["REQUEST_METHOD"] = "";
 		_meta_variables["SCRIPT_NAME"] = "";
 		_meta_variables["SERVER_NAME"] = "";
-		_meta_variables["SERVER_PORT"] = std::to_string(port_number);
 		_meta_variables["SERVER_PROTOCOL"] = "";
 		_meta_variables["SERVER_SOFTWARE"] = "";
+	}
 
+	/* a persistent connection runs several requests through the same handler, everything but the port is per request */
+	void CGIHandler::reset() {
+		close_child_pipe_ends(); // a CGI that never started
+		free_cgi_arguments();
+		initialize_cgi_arguments();
+		set_default_meta_variables();
+		_cgi_name.clear();
+		_cgi_extention.clear();
+		_search_cgi_extension = false;
 		_input_pipe[0] = -1;
 		_input_pipe[1] = -1;
 		_output_pipe[0] = -1;
 		_output_pipe[1] = -1;
-
-		_response = "";
-		initialize_cgi_arguments();
+		_response.clear();
+		_request_message_body.clear();
 	}
 
-	CGIHandler::~CGIHandler(){
+	void CGIHandler::initialize_cgi_arguments() {
 		for (int i = 0; i < Constants::ENVP_SIZE; i++) {
-			free(_envp[i]);
+			_envp[i] = NULL;
 		}
 		for (int i = 0; i < Constants::ARGUMENTS_SIZE; i++) {
-			free(_argument[i]);
+			_argument[i] = NULL;
 		}
 	}
 
-	void CGIHandler::initialize_cgi_arguments() {
+	void CGIHandler::free_cgi_arguments() {
 		for (int i = 0; i < Constants::ENVP_SIZE; i++) {
-			_envp[i] = NULL;
+			free(_envp[i]);
 		}
 		for (int i = 0; i < Constants::ARGUMENTS_SIZE; i++) {
-			_argument[i] = NULL;
+			free(_argument[i]);
 		}
 	}
 
@@ -70,8 +111,8 @@ namespace CGI{
 	{
 		_meta_variables["SERVER_PROTOCOL"] = "HTTP/1.1";
 		std::string authorization = "";
-		if (_http_request_message->has_header_field("AUTHORIZATION")) {
-			authorization= _http_request_message->get_header_value("AUTHORIZATION");
+		if (_http_request_message->has_header_field(HTTPRequest::HEADER_AUTHORIZATION)) {
+			authorization= _http_request_message->get_header_value(HTTPRequest::HEADER_AUTHORIZATION);
 			std::vector<std::string> authorisation_parts = Utility::_split_line_in_two(authorization, ' ');
 			if (authorisation_parts.size() > 0) {
 				_meta_variables["AUTH_TYPE"] = authorisation_parts[0];
@@ -80,11 +121,11 @@ namespace CGI{
 				}
 			}
 		}
-		if (_http_request_message->has_header_field("CONTENT_LENGTH")) {
-			_meta_variables["CONTENT_LENGTH"] = _http_request_message->get_header_value("CONTENT_LENGTH");
+		if (_http_request_message->has_header_field(HTTPRequest::HEADER_CONTENT_LENGTH)) {
+			_meta_variables["CONTENT_LENGTH"] = _http_request_message->get_header_value(HTTPRequest::HEADER_CONTENT_LENGTH);
 		}
-		if (_http_request_message->has_header_field("CONTENT_TYPE")) {
-			_meta_variables["CONTENT_TYPE"] = _http_request_message->get_header_value("CONTENT_TYPE");
+		if (_http_request_message->has_header_field(HTTPRequest::HEADER_CONTENT_TYPE)) {
+			_meta_variables["CONTENT_TYPE"] = _http_request_message->get_header_value(HTTPRequest::HEADER_CONTENT_TYPE);
 		}
 		_meta_variables["GATEWAY_INTERFACE"] = "CGI/1.1";
 		_meta_variables["PATH_INFO"] = "/cgi-bin/" + _cgi_name;//this is contradicting with the RFC, confirmed with Nicolas we can do it in RFC way
@@ -92,7 +133,7 @@ namespace CGI{
 		_meta_variables["QUERY_STRING"] = _http_request_message->get_uri().get_query();
 		_meta_variables["REMOTE_ADDR"] = "127.0.0.1";
 		if (_http_request_message->has_header_field("REMOTE_HOST")) {
-			_meta_variables["REMOTE_HOST"] = _http_request_message->get_header_value("HOST");
+			_meta_variables["REMOTE_HOST"] = _http_request_message->get_header_value(HTTPRequest::HEADER_HOST);
 		}
 		_meta_variables["SERVER_NAME"] = _meta_variables["REMOTE_HOST"];							
 		_meta_variables["REQUEST_METHOD"] = _http_request_message->get_method();// from method
@@ -153,22 +194,43 @@ namespace CGI{
 		search_cgi(path);
 		if(_search_cgi_extension == false)
 			return;	
+		struct stat buffer;
+		std::string relative_path = "cgi-bin/" + _cgi_name;
+		if(stat(relative_path.c_str(), &buffer) != 0)
+			_search_cgi_extension = false;
+		if(!_search_cgi_extension)
+			return;
+		// only a body the pipe takes at once is written to it, the child reads a bigger one from a file,
+		// taken care of before the pipes so a failure leaves none of their ends open
+		if (_http_request_message->get_payload_size() > static_cast<size_t>(Constants::CGI_PIPE_BODY_SIZE)
+			&& !_http_request_message->store_payload_in_file())
+			throw(CGIexception());
 		_request_message_body = _http_request_message->get_message_body();
+		if (_http_request_message->get_payload_fd() != -1) { // a copy, the request may be reset before the CGI runs
+			_request_body_fd = fcntl(_http_request_message->get_payload_fd(), F_DUPFD_CLOEXEC, 0);
+			if (_request_body_fd == Constants::ERROR) {
+				std::perror("fcntl");
+				throw(CGIexception());
+			}
+		}
 		if(pipe(_input_pipe) == Constants::ERROR){
 			std::perror("pipe");
 			throw(CGIexception());
 		}
 		if(pipe(_output_pipe) == Constants::ERROR){
 			std::perror("pipe");
+			close(_input_pipe[0]);
+			close(_input_pipe[1]);
+			_input_pipe[0] = -1;
+			_input_pipe[1] = -1;
 			throw(CGIexception());
 		}
+		for (int i = 0; i < 2; i++) { // the child gets its ends through dup2, which drops the flag
+			fcntl(_input_pipe[i], F_SETFD, FD_CLOEXEC);
+			fcntl(_output_pipe[i], F_SETFD, FD_CLOEXEC);
+		}
+		fcntl(_input_pipe[1], F_SETFL, O_NONBLOCK); // the body is written before the child runs, a full pipe must not stop the server
 		set_argument(_cgi_name);
-		struct stat buffer;
-		std::string relative_path = "cgi-bin/" + _cgi_name;
-		if(stat(relative_path.c_str(), &buffer) != 0)
-			_search_cgi_extension = false;
-		if(!_search_cgi_extension)
-			return;
 		parse_meta_variables(_http_request_message, _config);
 		set_envp();
 	}
@@ -197,40 +259,39 @@ namespace CGI{
 		return _socket_fd;
 	}
 
-	void CGIHandler::execute_cgi(int kq)
+	void CGIHandler::execute_cgi(HTTP::EventLoop& event_loop)
 	{
-		struct kevent kev;
-		EV_SET(&kev, _output_pipe[0], EVFILT_READ, EV_ADD, 0, 0, NULL);
-		if (kevent(kq, &kev, 1, NULL, 0, NULL)<0){
-			perror("kevent failure");
-			throw(CGIexception());
-			return;
-		}
+		event_loop.add_read_event(_output_pipe[0]);
 		pid_t pid = fork();
 		if(pid < 0){
 			perror("fork failure");
 			throw(CGIexception());
 		}
 		else if(pid == 0){
-			if(dup2(_input_pipe[0], 0) < 0){
+			// the child must never return into the server (it would run a copy of every event loop),
+			// and with worker threads only async-signal-safe calls are allowed before execve
+			int input_fd = _request_body_fd != -1 ? _request_body_fd : _input_pipe[0];
+			if(dup2(input_fd, 0) < 0){
 				perror("dup 1 failure");
-				throw(CGIexception());
+				_exit(EXIT_FAILURE);
+			}
+			if(_request_body_fd != -1 && lseek(0, 0, SEEK_SET) < 0){ // the offset is shared with the server's descriptor
+				perror("lseek failure");
+				_exit(EXIT_FAILURE);
 			}
 			if(dup2(_output_pipe[1], 1) < 0){
 				perror("dup 2 failure");
-				throw(CGIexception());
+				_exit(EXIT_FAILURE);
 			}
 			close(_output_pipe[0]);
 			close(_input_pipe[1]);
 			if(execve(_argument[0], _argument, _envp) == Constants::ERROR){
 				perror("execution error");//script is garanteed to be found
-				return;
+				_exit(EXIT_FAILURE);
 			}
 		}
 		else{
-			pid_t status_var;
-			waitpid(pid, &status_var, WNOHANG);
-			close(_input_pipe[0]);
+			close_child_pipe_ends(); // the output pipe only reports the end once the child is the last writer
 		}
 	}
 }
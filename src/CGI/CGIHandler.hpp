@@ -9,6 +9,7 @@
 #include "../HTTPRequest/RequestMessage.hpp"
 #include "../HTTPResponse/SpecifiedConfig.hpp"
 #include "../Constants.hpp"
+#include "../HTTP/EventLoop.hpp"
 
 namespace CGI{
 	class CGIHandler
@@ -22,20 +23,25 @@ namespace CGI{
 		bool _search_cgi_extension;
 		int _input_pipe[2];
 		int _output_pipe[2];
+		int _request_body_fd; // the temporary file of a body too big for memory, the child reads it instead of the input pipe
 		int _socket_fd;
 		std::string _response;
 		std::string _request_message_body;
 
 		void update_path_translated(void);
 		void initialize_cgi_arguments();
+		void free_cgi_arguments();
+		void set_default_meta_variables();
+		void close_child_pipe_ends();
 		class CGIexception : public std::exception{
-			const char* what() const _NOEXCEPT { return "internal server error"; }
+			const char* what() const throw() { return "internal server error"; }
 		};
 		CGIHandler();
 
 	public:		
 		CGIHandler(int port_number);
 		~CGIHandler();
+		void reset();
 		void parse_meta_variables(HTTPRequest::RequestMessage *_http_request_message, HTTPResponse::SpecifiedConfig &_config);
 		void prepare_cgi_data(HTTPRequest::RequestMessage *_http_request_message, HTTPResponse::SpecifiedConfig &_config, int socket_fd);
 		void search_cgi(std::vector<std::string> &path);
@@ -48,6 +54,6 @@ namespace CGI{
 		std::string get_response_message_body();
 		std::string get_request_message_body();
 		bool get_search_cgi_extention_result() const;
-		void execute_cgi(int kq);
+		void execute_cgi(HTTP::EventLoop& event_loop);
 	};
 }
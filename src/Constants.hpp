@@ -14,12 +14,36 @@
 #define RESET "\033[0m"
 
 namespace Constants {
-	const int PAYLOAD_MAX_LENGTH = 2097152; // 2MB
-	const int SEND_BUFFER_SIZE = 32768; // 32kB
+	const int SEND_MAX_CHUNK = 2097152; // 2MB, sent on a connection per write event at most
+	const int CGI_READ_BUFFER_SIZE = 65536; // 64kB, what a pipe holds
+	const int CGI_PIPE_BODY_SIZE = 16384; // 16kB, what a pipe holds on every platform, a bigger body reaches a CGI through a file
 	const int DEFAULT_MAX_SIZE_BODY = 8000000; // 8MB
+	const long MAX_CLIENT_BODY_SIZE = 64L * 1024 * 1024 * 1024; // 64GB, bodies that big only ever live in temporary files
+	const int DEFAULT_CLIENT_BODY_BUFFER_SIZE = 16384; // 16kB, same default as nginx on 64 bit platforms
+	const int BODY_READ_SIZE = 65536; // 64kB of a request body read back from its temporary file at once
+	const char* const CLIENT_BODY_TEMP_FILE = "/tmp/webserv_body_XXXXXX"; // template for mkstemp
+	const int MAX_LINE_LENGTH = 8192; // of the request line, a header field or a chunk size line
+	const int MAX_HEADER_FIELDS = 100;
 	const int ENVP_SIZE = 18;
 	const int ARGUMENTS_SIZE = 2;
-	const double CONNECTIONS_CHECKER_INTERVAL = 10;
-	const double NO_ACTIVITY_TIMEOUT = 60;
+	const int NO_ACTIVITY_TIMEOUT = 60;
+	const int DEFAULT_KEEPALIVE_TIMEOUT = 75; // seconds, same default as nginx
+	const int DEFAULT_KEEPALIVE_REQUESTS = 1000;
+	const int DEFAULT_EVENT_BATCH_SIZE = 512; // events harvested per kevent call
+	const int MAX_EVENT_BATCH_SIZE = 65536;
+	const int MAX_WORKER_THREADS = 256;
+	const int MAX_WORKER_PROCESSES = 256;
+	const int MAX_OPEN_FILE_CACHE = 65536; // entries, each one may hold an fd
+	const int DEFAULT_OPEN_FILE_CACHE_VALID = 60; // seconds
+	const int MAX_OPEN_FILE_CACHE_VALID = 86400;
+	const int MAX_CONTENT_CACHE = 536870912; // 512MB
+	const int DEFAULT_CONTENT_CACHE_MAX_FILE = 65536; // 64kB
+	const int HEADER_CACHE_ENTRIES = 4096; // header blocks of static files
+	const int MAX_RANGES = 16; // per request, more get the whole file
+	const int DEFAULT_GZIP_MIN_LENGTH = 20; // bytes, same default as nginx
+	const int DEFAULT_GZIP_COMP_LEVEL = 1;
+	const int GZIP_READ_SIZE = 65536; // 64kB of a file compressed per step of a gzip stream
+	const int OUTPUT_QUEUE_SIZE = 65536; // 64kB of responses the client has not read yet, no further pipelined request is answered
+	const int PIPELINED_INPUT_SIZE = 65536; // 64kB of requests held back, the socket is not read any further
 	const int ERROR = -1;
 }
@@ -6,6 +6,12 @@
 #include <iostream>
 #include <unistd.h>
 #include <errno.h>
+#include <sys/uio.h> // for writev
+#ifdef __linux__
+# include <sys/sendfile.h>
+#else
+# include <sys/socket.h>
+#endif
 
 
 namespace HTTP {
@@ -13,27 +19,41 @@ namespace HTTP {
 		: _socket_fd(connection_socket_fd)
 		, _listen_info(listen_info)
 		, _is_open(true)
-		, logtime_counter()
+		, _timer()
 		, request_handler(new RequestHandler(*this, config_data, _listen_info))
 		, my_connection_addr(connection_addr)
 		{
 			_cgi_write_read_fd[0] = -1;
 			_cgi_write_read_fd[1] = -1;
+			_timer.id = connection_socket_fd;
 		}
 
 	Connection::~Connection(){
 	}
 
-	void Connection::handle_http_request(int kq) {
-		request_handler->handle_http_request(kq, _socket_fd);
-		if(request_handler->get_search_cgi_extention_result()){
-			set_cgi_write_fd(request_handler->get_cgi_write_fd());
-			set_cgi_read_fd(request_handler->get_cgi_read_fd());
-		}
+	void Connection::handle_http_request(EventLoop& event_loop) {
+		request_handler->handle_http_request(event_loop, _socket_fd);
+		_sync_cgi_fds();
 	}
  
-	void Connection::send_response() {
+	void Connection::send_response(EventLoop& event_loop) {
+		request_handler->handle_pipelined_requests(event_loop, _socket_fd);
 		request_handler->send_response();
+		if (!request_handler->has_response_to_send()) // the write events stop now, the requests held back until everything was out go on here
+			request_handler->handle_pipelined_requests(event_loop, _socket_fd);
+		_sync_cgi_fds();
+	}
+
+	// the pipe fds are only tracked while the handler waits for the output of a CGI
+	void Connection::_sync_cgi_fds() {
+		if (!request_handler->is_waiting_for_cgi()) {
+			set_cgi_write_fd(-1);
+			set_cgi_read_fd(-1);
+		}
+		else if (get_cgi_read_fd() == -1) { // a new CGI has just been started
+			set_cgi_write_fd(request_handler->get_cgi_write_fd());
+			set_cgi_read_fd(request_handler->get_cgi_read_fd());
+		}
 	}
 
 	void Connection::set_cgi_write_fd(int i){
@@ -48,12 +68,35 @@ namespace HTTP {
 		request_handler->handle_internal_server_error();
 	}
 
+	void Connection::set_cgi_response(std::string &output){
+		request_handler->set_cgi_response(output);
+	}
+
 	bool Connection::is_connection_open() const {
 		return _is_open;
 	}
 
-	bool Connection::is_hanging_connection() {
-		return logtime_counter.is_bigger_than_time_limit(Constants::NO_ACTIVITY_TIMEOUT);
+	// seconds of silence after which the connection is closed
+	int Connection::get_timeout() {
+		if (request_handler->is_idle())
+			return request_handler->get_keepalive_timeout();
+		return Constants::NO_ACTIVITY_TIMEOUT;
+	}
+
+	Utility::TimerWheel::Timer &Connection::get_timer() {
+		return _timer;
+	}
+
+	bool Connection::is_idle() {
+		return request_handler->is_idle();
+	}
+
+	bool Connection::has_pending_response() {
+		return request_handler->has_pending_response();
+	}
+
+	bool Connection::has_response_to_send() {
+		return request_handler->has_response_to_send();
 	}
 
 	int Connection::get_cgi_write_fd() const{
@@ -62,37 +105,62 @@ namespace HTTP {
 
 	int Connection::get_cgi_read_fd() const{
 		return _cgi_write_read_fd[1];
+	}
+
+	void Connection::append_cgi_output(const char *data, size_t size) {
+		_cgi_output.append(data, size);
+	}
+
+	std::string &Connection::get_cgi_output() {
+		return _cgi_output;
 	}	
 
 	std::string Connection::get_request_message_body(){
 		return request_handler->get_request_message_body();
 	}
 
-	void Connection::send(std::string& buffer, size_t buffer_size) {
-		size_t current_buffer_size;
-		if (buffer_size < Constants::SEND_BUFFER_SIZE) {
-			current_buffer_size = buffer_size;
-		}
-		else {
-			current_buffer_size = Constants::SEND_BUFFER_SIZE;
-		}
-		ssize_t bytes_sent = ::send(_socket_fd, buffer.c_str(), current_buffer_size, 0);
+	// the socket is non-blocking, a full send buffer is no error, the rest goes with the next write event
+	ssize_t Connection::send(const struct iovec *iov, int iov_count) {
+		ssize_t bytes_sent = ::writev(_socket_fd, iov, iov_count);
 		if (bytes_sent < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+				return 0;
 			Utility::logger("Send failed. errno: " + Utility::to_string(errno), RED);
 			this->close();
-			return;
+			return Constants::ERROR;
 		}
-		logtime_counter.update_last_activity_logtime();
-		if (bytes_sent == 0) {
-			return;
+		return bytes_sent;
+	}
+
+	// the page cache goes straight to the socket, the file is never copied into user space
+	ssize_t Connection::send_file(int file_fd, off_t& offset, size_t count) {
+#ifdef __linux__
+		ssize_t bytes_sent = ::sendfile(_socket_fd, file_fd, &offset, count);
+#else
+		off_t length = count;
+		ssize_t bytes_sent = ::sendfile(file_fd, _socket_fd, offset, &length, NULL, 0);
+		if (bytes_sent == Constants::ERROR && (errno == EAGAIN || errno == EINTR)) { // the bytes sent before the interruption are in length
+			offset += length;
+			return length;
 		}
-		if (buffer_size > (size_t)bytes_sent) { // erasing the part that has been sent if the buffer is bigger than we can handle
-			buffer.erase(0, (size_t)bytes_sent);
+		if (bytes_sent != Constants::ERROR) {
+			bytes_sent = length;
+			offset += length;
+		}
+#endif
+		if (bytes_sent < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+				return 0;
+			Utility::logger("Sendfile failed. errno: " + Utility::to_string(errno), RED);
+			this->close();
+			return Constants::ERROR;
 		}
-		else {
-			buffer.clear();
+		if (bytes_sent == 0 && count != 0) { // the file got shorter than its Content-Length
+			Utility::logger("File truncated while being sent on " + Utility::to_string(_socket_fd), RED);
 			this->close();
+			return Constants::ERROR;
 		}
+		return bytes_sent;
 	}
 
 	void Connection::close() {
@@ -105,7 +173,6 @@ namespace HTTP {
 	}
 
 	size_t Connection::receive(char* buffer, size_t buffer_size) {
-		logtime_counter.update_last_activity_logtime();
 		return ::recv(_socket_fd, buffer, buffer_size, 0);
 	}
 
@@ -119,9 +186,10 @@ namespace HTTP {
 
 	void Connection::set_response_true(){
 		request_handler->set_response_true();
+		_sync_cgi_fds();
 	}
 
-	void Connection::execute_cgi(int kq){
-		request_handler->execute_cgi(kq);
+	void Connection::execute_cgi(EventLoop& event_loop){
+		request_handler->execute_cgi(event_loop);
 	}
 }
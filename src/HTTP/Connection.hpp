@@ -6,8 +6,9 @@
 #include "RequestHandler.hpp"
 #include "RequestHandlerDelegate.hpp"
 #include "ServerStructs.hpp"
+#include "EventLoop.hpp"
 #include "../Utility/SmartPointer.hpp"
-#include "../Utility/LogTimeCounter.hpp"
+#include "../Utility/TimerWheel.hpp"
 
 namespace HTTP {
 	class Connection : public RequestHandlerDelegate
@@ -17,31 +18,41 @@ namespace HTTP {
 		ListenInfo& _listen_info;
 		bool _is_open;
 		int _cgi_write_read_fd[2];//first number stores the write, second stores the read
-		Utility::LogTimeCounter logtime_counter;
+		Utility::TimerWheel::Timer _timer;
+		std::string _cgi_output;
 		Utility::SmartPointer<RequestHandler> request_handler;
 
+		void _sync_cgi_fds();
+
 	public:
 		Connection(int connection_socket_fd, Config::ConfigData *config_data, ListenInfo& _listen_info, sockaddr_in connection_addr);
 		~Connection();
 
 		sockaddr_in my_connection_addr;
-		void handle_http_request(int kq);
-		void send_response();
+		void handle_http_request(EventLoop& event_loop);
+		void send_response(EventLoop& event_loop);
 		void set_cgi_write_fd(int i);
 		void set_cgi_read_fd(int i);
 		void handle_internal_server_error();
+		void set_cgi_response(std::string &output);
 		virtual int get_fd();
 		bool is_connection_open() const;
-		bool is_hanging_connection();
-		void set_last_activity_time();
+		int get_timeout();
+		Utility::TimerWheel::Timer &get_timer();
+		bool is_idle();
+		bool has_pending_response();
+		bool has_response_to_send();
 		int get_cgi_write_fd() const;
 		int get_cgi_read_fd() const;
+		void append_cgi_output(const char *data, size_t size);
+		std::string &get_cgi_output();
 		std::string get_request_message_body();
 		HTTPResponse::ResponseMessage &get_response_message();
 		virtual size_t receive(char *buffer, size_t buffer_size);
-		virtual void send(std::string& buffer, size_t buffer_size);
+		virtual ssize_t send(const struct iovec *iov, int iov_count);
+		virtual ssize_t send_file(int file_fd, off_t& offset, size_t count);
 		virtual void close();
 		void set_response_true();
-		void execute_cgi(int kq);
+		void execute_cgi(EventLoop& event_loop);
 	};
 }
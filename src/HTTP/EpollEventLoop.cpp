@@ -0,0 +1,128 @@
+#include "EpollEventLoop.hpp"
+
+#ifdef __linux__
+
+#include <unistd.h> // for close
+#include <errno.h>
+#include <cstring> // for memset
+#include <stdexcept>
+
+#include "../Utility/Utility.hpp"
+#include "../Constants.hpp"
+
+namespace HTTP {
+	EpollEventLoop::EpollEventLoop(int max_events)
+	: _fd(epoll_create1(EPOLL_CLOEXEC))
+	, _wanted()
+	, _registered()
+	, _changed_fds()
+	, _epoll_events(max_events)
+	{
+		if (_fd < 0)
+			throw std::runtime_error("Error creating epoll instance. errno: " + Utility::to_string(errno));
+	}
+
+	EpollEventLoop::~EpollEventLoop() {
+		close(_fd);
+	}
+
+	void EpollEventLoop::_change_interest(int fd, unsigned char interest, bool enable) {
+		if (fd < 0)
+			return;
+		if (static_cast<size_t>(fd) >= _wanted.size()) {
+			_wanted.resize(fd + 1, NONE);
+			_registered.resize(fd + 1, NONE);
+		}
+		if (_wanted[fd] == _registered[fd]) // first change of this fd since the last wait
+			_changed_fds.push_back(fd);
+		if (enable)
+			_wanted[fd] |= interest;
+		else
+			_wanted[fd] &= ~interest;
+	}
+
+	void EpollEventLoop::add_read_event(int fd) {
+		_change_interest(fd, READ_INTEREST, true);
+	}
+
+	void EpollEventLoop::add_write_event(int fd) {
+		_change_interest(fd, WRITE_INTEREST, true);
+	}
+
+	void EpollEventLoop::delete_read_event(int fd) {
+		_change_interest(fd, READ_INTEREST, false);
+	}
+
+	void EpollEventLoop::delete_write_event(int fd) {
+		_change_interest(fd, WRITE_INTEREST, false);
+	}
+
+	// a closed fd leaves the epoll set on its own (sockets and pipes are close-on-exec, no child keeps them open),
+	// only the bookkeeping has to be dropped before the number gets reused
+	void EpollEventLoop::forget(int fd) {
+		if (fd >= 0 && static_cast<size_t>(fd) < _wanted.size()) {
+			_wanted[fd] = NONE;
+			_registered[fd] = NONE;
+		}
+		_forgotten_fds.push_back(fd);
+	}
+
+	// one epoll_ctl per changed fd, failures are reported as events carrying the errno
+	int EpollEventLoop::_apply_changes() {
+		int failed = 0;
+		for (size_t i = 0; i < _changed_fds.size(); i++) {
+			int fd = _changed_fds[i];
+			if (_wanted[fd] == _registered[fd])
+				continue;
+			struct epoll_event ev;
+			std::memset(&ev, 0, sizeof(ev));
+			ev.data.fd = fd;
+			if (_wanted[fd] & READ_INTEREST)
+				ev.events |= EPOLLIN | EPOLLRDHUP;
+			if (_wanted[fd] & WRITE_INTEREST)
+				ev.events |= EPOLLOUT;
+			int operation = EPOLL_CTL_MOD;
+			if (_wanted[fd] == NONE)
+				operation = EPOLL_CTL_DEL;
+			else if (_registered[fd] == NONE)
+				operation = EPOLL_CTL_ADD;
+			if (epoll_ctl(_fd, operation, fd, &ev) == Constants::ERROR) {
+				Filter filter = (_wanted[fd] & ~_registered[fd] & WRITE_INTEREST) ? WRITE : READ;
+				_set_event(failed++, fd, filter, false, errno);
+				_wanted[fd] = _registered[fd];
+				continue;
+			}
+			_registered[fd] = _wanted[fd];
+		}
+		_changed_fds.clear();
+		return failed;
+	}
+
+	// applies the pending changes and waits for the next batch of events
+	int EpollEventLoop::wait(int timeout_sec) {
+		_forgotten_fds.clear();
+		int new_events = _apply_changes();
+		int timeout_ms = timeout_sec < 0 ? -1 : timeout_sec * 1000;
+		if (new_events) // failed changes are reported without delay
+			timeout_ms = 0;
+		int ready = epoll_wait(_fd, &_epoll_events[0], _epoll_events.size(), timeout_ms);
+		if (ready == Constants::ERROR)
+			return new_events ? new_events : Constants::ERROR;
+		for (int i = 0; i < ready; i++) {
+			int fd = _epoll_events[i].data.fd;
+			uint32_t flags = _epoll_events[i].events;
+			bool hangup = flags & (EPOLLHUP | EPOLLERR);
+			if ((_registered[fd] & READ_INTEREST) && (flags & (EPOLLIN | EPOLLRDHUP) || hangup))
+				_set_event(new_events++, fd, READ, hangup || (flags & EPOLLRDHUP), 0);
+			if ((_registered[fd] & WRITE_INTEREST) && (flags & EPOLLOUT || hangup))
+				_set_event(new_events++, fd, WRITE, hangup, 0);
+		}
+		return new_events;
+	}
+
+	const std::string EpollEventLoop::get_name() const {
+		return "epoll";
+	}
+}
+
+#endif
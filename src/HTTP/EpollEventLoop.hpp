@@ -0,0 +1,46 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <vector>
+#include <sys/epoll.h>
+
+#include "EventLoop.hpp"
+
+namespace HTTP {
+	// epoll backend. epoll has no changelist, so the wanted interests are coalesced per fd
+	// and turn into at most one epoll_ctl call for each changed fd right before waiting.
+	class EpollEventLoop : public EventLoop
+	{
+	private:
+		enum Interest
+		{
+			NONE = 0,
+			READ_INTEREST = 1,
+			WRITE_INTEREST = 2
+		};
+
+		int _fd;
+		std::vector<unsigned char> _wanted; // indexed by fd
+		std::vector<unsigned char> _registered; // what the kernel currently knows, indexed by fd
+		std::vector<int> _changed_fds;
+		std::vector<struct epoll_event> _epoll_events;
+
+		void _change_interest(int fd, unsigned char interest, bool enable);
+		int _apply_changes();
+
+	public:
+		EpollEventLoop(int max_events);
+		~EpollEventLoop();
+
+		void add_read_event(int fd);
+		void add_write_event(int fd);
+		void delete_read_event(int fd);
+		void delete_write_event(int fd);
+		void forget(int fd);
+		int wait(int timeout_sec);
+		const std::string get_name() const;
+	};
+}
+
+#endif
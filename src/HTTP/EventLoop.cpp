@@ -0,0 +1,64 @@
+#include "EventLoop.hpp"
+
+#include <algorithm>
+#include <exception>
+
+#ifdef __linux__
+	#include "EpollEventLoop.hpp"
+	#include "IoUringEventLoop.hpp"
+#else
+	#include "KqueueEventLoop.hpp"
+#endif
+#include "../Utility/Utility.hpp"
+#include "../Constants.hpp"
+
+namespace HTTP {
+	EventLoop::EventLoop()
+	: _events()
+	, _forgotten_fds()
+	{}
+
+	EventLoop::~EventLoop() {}
+
+	// the native mechanism of the platform (epoll on Linux, kqueue on BSD and macOS) unless the config asks for io_uring
+	EventLoop* EventLoop::create(int max_events, const std::string& backend) {
+		if (backend == "io_uring") {
+#ifdef HAS_IO_URING
+			try {
+				return new IoUringEventLoop(max_events);
+			}
+			catch (const std::exception& e) {
+				Utility::logger(std::string(e.what()) + ", falling back to the native event loop", YELLOW);
+			}
+#else
+			Utility::logger("io_uring is not available in this build, falling back to the native event loop", YELLOW);
+#endif
+		}
+#ifdef __linux__
+		if (backend == "kqueue")
+			Utility::logger("kqueue is not available on this platform, using epoll", YELLOW);
+		return new EpollEventLoop(max_events);
+#else
+		if (backend == "epoll")
+			Utility::logger("epoll is not available on this platform, using kqueue", YELLOW);
+		return new KqueueEventLoop(max_events);
+#endif
+	}
+
+	bool EventLoop::is_forgotten(int fd) const {
+		return std::find(_forgotten_fds.begin(), _forgotten_fds.end(), fd) != _forgotten_fds.end();
+	}
+
+	const EventLoop::Event& EventLoop::get_event(int index) const {
+		return _events[index];
+	}
+
+	void EventLoop::_set_event(int index, int fd, Filter filter, bool eof, int error) {
+		if (static_cast<size_t>(index) >= _events.size())
+			_events.resize(index + 1);
+		_events[index].fd = fd;
+		_events[index].filter = filter;
+		_events[index].eof = eof;
+		_events[index].error = error;
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+namespace HTTP {
+	// Readiness notification for the server, independent of the kernel mechanism behind it.
+	// Registrations are collected and handed to the kernel together with the next wait,
+	// which harvests up to max_events events at once.
+	class EventLoop
+	{
+	public:
+		enum Filter
+		{
+			READ,
+			WRITE
+		};
+
+		struct Event
+		{
+			int fd;
+			Filter filter;
+			bool eof;
+			int error; // errno of a registration that could not be applied, 0 otherwise
+		};
+
+		virtual ~EventLoop();
+
+		virtual void add_read_event(int fd) = 0;
+		virtual void add_write_event(int fd) = 0;
+		virtual void delete_read_event(int fd) = 0;
+		virtual void delete_write_event(int fd) = 0;
+		virtual void forget(int fd) = 0;
+		virtual int wait(int timeout_sec) = 0; // a negative timeout waits until an event comes in
+		virtual const std::string get_name() const = 0;
+
+		bool is_forgotten(int fd) const;
+		const Event& get_event(int index) const;
+
+		static EventLoop* create(int max_events, const std::string& backend);
+
+	protected:
+		std::vector<Event> _events;
+		std::vector<int> _forgotten_fds; // closed during the current batch, their remaining events are stale
+
+		EventLoop();
+		void _set_event(int index, int fd, Filter filter, bool eof, int error);
+
+	private:
+		EventLoop(const EventLoop& other);
+		EventLoop& operator=(const EventLoop& other);
+	};
+}
@@ -0,0 +1,255 @@
+#include "IoUringEventLoop.hpp"
+
+#ifdef HAS_IO_URING
+
+#include <unistd.h> // for close and syscall
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <errno.h>
+#include <cstring> // for memset
+#include <stdexcept>
+
+#include "../Utility/Utility.hpp"
+#include "../Constants.hpp"
+
+namespace HTTP {
+	namespace {
+		const __u64 CANCEL_USER_DATA = ~static_cast<__u64>(0); // completions of the cancel requests themselves
+		const unsigned MAX_RING_ENTRIES = 4096;
+	}
+
+	IoUringEventLoop::IoUringEventLoop(int max_events)
+	: _ring_fd(-1)
+	, _max_events(max_events)
+	, _sq_ring(MAP_FAILED)
+	, _sq_ring_size(0)
+	, _cq_ring(MAP_FAILED)
+	, _cq_ring_size(0)
+	, _sqes(static_cast<struct io_uring_sqe *>(MAP_FAILED))
+	, _sqes_size(0)
+	, _sq_entries(0)
+	, _wanted()
+	, _armed()
+	, _generation()
+	, _changed_fds()
+	{
+		unsigned entries = max_events > static_cast<int>(MAX_RING_ENTRIES) ? MAX_RING_ENTRIES : max_events;
+		_setup_rings(entries);
+	}
+
+	IoUringEventLoop::~IoUringEventLoop() {
+		_release_rings();
+	}
+
+	// the kernel may lack io_uring or be too old for it, the caller falls back to epoll then
+	void IoUringEventLoop::_setup_rings(unsigned entries) {
+		struct io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+		_ring_fd = syscall(__NR_io_uring_setup, entries, &params);
+		if (_ring_fd < 0)
+			throw std::runtime_error("io_uring_setup failed. errno: " + Utility::to_string(errno));
+		if (!(params.features & IORING_FEAT_NODROP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+			_release_rings();
+			throw std::runtime_error("io_uring of this kernel is too old");
+		}
+		_sq_entries = params.sq_entries;
+		_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+		if (params.features & IORING_FEAT_SINGLE_MMAP) { // both rings live in one mapping
+			if (_cq_ring_size > _sq_ring_size)
+				_sq_ring_size = _cq_ring_size;
+			_cq_ring_size = 0;
+		}
+		_sq_ring = mmap(NULL, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+		_cq_ring = _sq_ring;
+		if (_sq_ring != MAP_FAILED && _cq_ring_size)
+			_cq_ring = mmap(NULL, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_CQ_RING);
+		_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+		_sqes = static_cast<struct io_uring_sqe *>(mmap(NULL, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES));
+		if (_sq_ring == MAP_FAILED || _cq_ring == MAP_FAILED || _sqes == MAP_FAILED) {
+			int mmap_errno = errno;
+			_release_rings();
+			throw std::runtime_error("io_uring ring mapping failed. errno: " + Utility::to_string(mmap_errno));
+		}
+		char *sq = static_cast<char *>(_sq_ring);
+		char *cq = static_cast<char *>(_cq_ring);
+		_sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+		_sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+		_sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+		_sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+		_cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+		_cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+		_cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+		_cqes = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+	}
+
+	void IoUringEventLoop::_release_rings() {
+		if (_sqes != MAP_FAILED)
+			munmap(_sqes, _sqes_size);
+		if (_cq_ring != MAP_FAILED && _cq_ring != _sq_ring)
+			munmap(_cq_ring, _cq_ring_size);
+		if (_sq_ring != MAP_FAILED)
+			munmap(_sq_ring, _sq_ring_size);
+		_sqes = static_cast<struct io_uring_sqe *>(MAP_FAILED);
+		_cq_ring = MAP_FAILED;
+		_sq_ring = MAP_FAILED;
+		if (_ring_fd >= 0)
+			close(_ring_fd);
+		_ring_fd = -1;
+	}
+
+	int IoUringEventLoop::_enter(unsigned min_complete, unsigned flags, void *arg, size_t arg_size) {
+		unsigned to_submit = *_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+		return syscall(__NR_io_uring_enter, _ring_fd, to_submit, min_complete, flags, arg, arg_size);
+	}
+
+	// queued in the submission ring, the kernel only sees it with the next io_uring_enter
+	void IoUringEventLoop::_push_sqe(const struct io_uring_sqe& sqe) {
+		unsigned tail = *_sq_tail;
+		if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries) { // ring is full, hand it over right away
+			_enter(0, 0, NULL, 0);
+		}
+		unsigned index = tail & *_sq_mask;
+		_sqes[index] = sqe;
+		_sq_array[index] = index;
+		__atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+	}
+
+	__u64 IoUringEventLoop::_user_data(int fd) const {
+		return (static_cast<__u64>(_generation[fd]) << 32) | static_cast<unsigned>(fd);
+	}
+
+	void IoUringEventLoop::_arm(int fd) {
+		struct io_uring_sqe sqe;
+		std::memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode = IORING_OP_POLL_ADD;
+		sqe.fd = fd;
+		if (_wanted[fd] & READ_INTEREST)
+			sqe.poll32_events |= POLLIN | POLLRDHUP;
+		if (_wanted[fd] & WRITE_INTEREST)
+			sqe.poll32_events |= POLLOUT;
+		sqe.user_data = _user_data(fd);
+		_push_sqe(sqe);
+		_armed[fd] = _wanted[fd];
+	}
+
+	// also drops the reference the poll holds on the file, which would otherwise keep a closed socket alive
+	void IoUringEventLoop::_cancel(int fd) {
+		struct io_uring_sqe sqe;
+		std::memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode = IORING_OP_POLL_REMOVE;
+		sqe.fd = -1;
+		sqe.addr = _user_data(fd);
+		sqe.user_data = CANCEL_USER_DATA;
+		_push_sqe(sqe);
+		_armed[fd] = NONE;
+		_generation[fd]++;
+	}
+
+	void IoUringEventLoop::_change_interest(int fd, unsigned char interest, bool enable) {
+		if (fd < 0)
+			return;
+		if (static_cast<size_t>(fd) >= _wanted.size()) {
+			_wanted.resize(fd + 1, NONE);
+			_armed.resize(fd + 1, NONE);
+			_generation.resize(fd + 1, 0);
+		}
+		if (enable)
+			_wanted[fd] |= interest;
+		else
+			_wanted[fd] &= ~interest;
+		_changed_fds.push_back(fd);
+	}
+
+	void IoUringEventLoop::add_read_event(int fd) {
+		_change_interest(fd, READ_INTEREST, true);
+	}
+
+	void IoUringEventLoop::add_write_event(int fd) {
+		_change_interest(fd, WRITE_INTEREST, true);
+	}
+
+	void IoUringEventLoop::delete_read_event(int fd) {
+		_change_interest(fd, READ_INTEREST, false);
+	}
+
+	void IoUringEventLoop::delete_write_event(int fd) {
+		_change_interest(fd, WRITE_INTEREST, false);
+	}
+
+	void IoUringEventLoop::forget(int fd) {
+		if (fd >= 0 && static_cast<size_t>(fd) < _wanted.size()) {
+			_wanted[fd] = NONE;
+			if (_armed[fd] != NONE)
+				_cancel(fd);
+		}
+		_forgotten_fds.push_back(fd);
+	}
+
+	void IoUringEventLoop::_apply_changes() {
+		for (size_t i = 0; i < _changed_fds.size(); i++) {
+			int fd = _changed_fds[i];
+			if (_wanted[fd] == _armed[fd])
+				continue;
+			if (_armed[fd] != NONE)
+				_cancel(fd);
+			if (_wanted[fd] != NONE)
+				_arm(fd);
+		}
+		_changed_fds.clear();
+	}
+
+	int IoUringEventLoop::_reap_completions() {
+		int new_events = 0;
+		unsigned head = *_cq_head;
+		unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+		while (head != tail && new_events < _max_events) {
+			const struct io_uring_cqe& cqe = _cqes[head & *_cq_mask];
+			head++;
+			if (cqe.user_data == CANCEL_USER_DATA)
+				continue;
+			int fd = static_cast<int>(cqe.user_data & 0xffffffffu);
+			if (static_cast<size_t>(fd) >= _armed.size() || cqe.user_data != _user_data(fd))
+				continue; // the poll was cancelled in the meantime
+			unsigned char interest = _armed[fd];
+			_armed[fd] = NONE;
+			_changed_fds.push_back(fd); // re-armed with the next wait as long as it's still wanted
+			if (cqe.res < 0) {
+				_wanted[fd] = NONE;
+				_set_event(new_events++, fd, (interest & READ_INTEREST) ? READ : WRITE, false, -cqe.res);
+				continue;
+			}
+			bool hangup = cqe.res & (POLLHUP | POLLERR);
+			if ((interest & READ_INTEREST) && ((cqe.res & (POLLIN | POLLRDHUP)) || hangup))
+				_set_event(new_events++, fd, READ, hangup || (cqe.res & POLLRDHUP), 0);
+			if ((interest & WRITE_INTEREST) && ((cqe.res & POLLOUT) || hangup))
+				_set_event(new_events++, fd, WRITE, hangup, 0);
+		}
+		__atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+		return new_events;
+	}
+
+	// submits every pending poll and waits for completions in the same syscall
+	int IoUringEventLoop::wait(int timeout_sec) {
+		_forgotten_fds.clear();
+		_apply_changes();
+		struct __kernel_timespec timeout;
+		timeout.tv_sec = timeout_sec;
+		timeout.tv_nsec = 0;
+		struct io_uring_getevents_arg arg;
+		std::memset(&arg, 0, sizeof(arg));
+		if (timeout_sec >= 0)
+			arg.ts = reinterpret_cast<__u64>(&timeout);
+		if (_enter(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)) == Constants::ERROR
+			&& errno != ETIME && errno != EINTR && errno != EBUSY)
+			return Constants::ERROR;
+		return _reap_completions();
+	}
+
+	const std::string IoUringEventLoop::get_name() const {
+		return "io_uring";
+	}
+}
+
+#endif
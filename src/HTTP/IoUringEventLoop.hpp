@@ -0,0 +1,79 @@
+#pragma once
+
+#if defined(__linux__) && defined(__has_include)
+	#if __has_include(<linux/io_uring.h>)
+		#define HAS_IO_URING
+	#endif
+#endif
+
+#ifdef HAS_IO_URING
+
+#include <vector>
+#include <cstddef>
+#include <linux/io_uring.h>
+
+#include "EventLoop.hpp"
+
+namespace HTTP {
+	// io_uring backend. Every readiness wait is a one shot IORING_OP_POLL_ADD, re-armed after it fired,
+	// which keeps the level triggered behaviour the handlers rely on. All the polls (re)armed or cancelled
+	// during a loop iteration go to the kernel with the io_uring_enter call that waits for the completions,
+	// so an iteration costs a single syscall no matter how many fds it touched.
+	class IoUringEventLoop : public EventLoop
+	{
+	private:
+		enum Interest
+		{
+			NONE = 0,
+			READ_INTEREST = 1,
+			WRITE_INTEREST = 2
+		};
+
+		int _ring_fd;
+		int _max_events;
+		void *_sq_ring;
+		size_t _sq_ring_size;
+		void *_cq_ring;
+		size_t _cq_ring_size;
+		struct io_uring_sqe *_sqes;
+		size_t _sqes_size;
+		unsigned _sq_entries;
+		unsigned *_sq_head;
+		unsigned *_sq_tail;
+		unsigned *_sq_mask;
+		unsigned *_sq_array;
+		unsigned *_cq_head;
+		unsigned *_cq_tail;
+		unsigned *_cq_mask;
+		struct io_uring_cqe *_cqes;
+		std::vector<unsigned char> _wanted; // indexed by fd
+		std::vector<unsigned char> _armed; // interest of the poll in flight, indexed by fd
+		std::vector<unsigned int> _generation; // tells completions of cancelled polls apart, indexed by fd
+		std::vector<int> _changed_fds;
+
+		void _setup_rings(unsigned entries);
+		void _release_rings();
+		void _push_sqe(const struct io_uring_sqe& sqe);
+		int _enter(unsigned min_complete, unsigned flags, void *arg, size_t arg_size);
+		__u64 _user_data(int fd) const;
+		void _arm(int fd);
+		void _cancel(int fd);
+		void _change_interest(int fd, unsigned char interest, bool enable);
+		void _apply_changes();
+		int _reap_completions();
+
+	public:
+		IoUringEventLoop(int max_events);
+		~IoUringEventLoop();
+
+		void add_read_event(int fd);
+		void add_write_event(int fd);
+		void delete_read_event(int fd);
+		void delete_write_event(int fd);
+		void forget(int fd);
+		int wait(int timeout_sec);
+		const std::string get_name() const;
+	};
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "KqueueEventLoop.hpp"
+
+#ifndef __linux__
+
+#include <unistd.h> // for close
+#include <errno.h>
+#include <stdexcept>
+
+#include "../Utility/Utility.hpp"
+
+namespace HTTP {
+	KqueueEventLoop::KqueueEventLoop(int max_events)
+	: _fd(kqueue()) //creates a new kernel event queue and returns a descriptor.
+	, _changelist()
+	, _kevents(max_events)
+	{
+		if (_fd < 0)
+			throw std::runtime_error("Error creating kqueue. errno: " + Utility::to_string(errno));
+	}
+
+	KqueueEventLoop::~KqueueEventLoop() {
+		close(_fd);
+	}
+
+	void KqueueEventLoop::_add_change(int identifier, short filter, unsigned short flags) {
+		struct kevent kev;
+		EV_SET(&kev, identifier, filter, flags, 0, 0, NULL); // is a macro which is provided for ease of initializing a kevent structure.
+		_changelist.push_back(kev);
+	}
+
+	void KqueueEventLoop::add_read_event(int fd) {
+		_add_change(fd, EVFILT_READ, EV_ADD);
+	}
+
+	void KqueueEventLoop::add_write_event(int fd) {
+		_add_change(fd, EVFILT_WRITE, EV_ADD);
+	}
+
+	void KqueueEventLoop::delete_read_event(int fd) {
+		_add_change(fd, EVFILT_READ, EV_DELETE);
+	}
+
+	void KqueueEventLoop::delete_write_event(int fd) {
+		_add_change(fd, EVFILT_WRITE, EV_DELETE);
+	}
+
+	// the fd got closed, which already removed its events from the kqueue:
+	// its pending changes must not reach a new owner of the same number
+	void KqueueEventLoop::forget(int fd) {
+		std::vector<struct kevent>::iterator it = _changelist.begin();
+		while (it != _changelist.end()) {
+			if (static_cast<int>(it->ident) == fd)
+				it = _changelist.erase(it);
+			else
+				++it;
+		}
+		_forgotten_fds.push_back(fd);
+	}
+
+	// submits the pending changelist and waits for the next batch of events
+	int KqueueEventLoop::wait(int timeout_sec) {
+		struct timespec timeout;
+		timeout.tv_sec = timeout_sec;
+		timeout.tv_nsec = 0;
+		struct kevent *changes = _changelist.empty() ? NULL : &_changelist[0];
+		int new_events = kevent(_fd, changes, _changelist.size(), &_kevents[0], _kevents.size(), timeout_sec < 0 ? NULL : &timeout);
+		_changelist.clear();
+		_forgotten_fds.clear();
+		for (int i = 0; i < new_events; i++) {
+			const struct kevent& kev = _kevents[i];
+			Filter filter = kev.filter == EVFILT_WRITE ? WRITE : READ;
+			int error = (kev.flags & EV_ERROR) ? static_cast<int>(kev.data) : 0;
+			_set_event(i, kev.ident, filter, kev.flags & EV_EOF, error);
+		}
+		return new_events;
+	}
+
+	const std::string KqueueEventLoop::get_name() const {
+		return "kqueue";
+	}
+}
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#ifndef __linux__
+
+#include <vector>
+#include <sys/event.h> // for kqueue and kevent
+
+#include "EventLoop.hpp"
+
+namespace HTTP {
+	// kqueue backend, registrations pile up in the changelist that is passed to the kevent call waiting for events
+	class KqueueEventLoop : public EventLoop
+	{
+	private:
+		int _fd;
+		std::vector<struct kevent> _changelist;
+		std::vector<struct kevent> _kevents;
+
+		void _add_change(int identifier, short filter, unsigned short flags);
+
+	public:
+		KqueueEventLoop(int max_events);
+		~KqueueEventLoop();
+
+		void add_read_event(int fd);
+		void add_write_event(int fd);
+		void delete_read_event(int fd);
+		void delete_write_event(int fd);
+		void forget(int fd);
+		int wait(int timeout_sec);
+		const std::string get_name() const;
+	};
+}
+
+#endif
@@ -0,0 +1,226 @@
+#include "OutputQueue.hpp"
+
+#include <unistd.h> // for close, pread
+#include <stdio.h> // for perror
+#include <sys/uio.h> // for iovec
+
+#include "../Constants.hpp"
+
+namespace HTTP {
+
+	OutputQueue::Segment::Segment()
+	: data()
+	, shared()
+	, data_offset(0)
+	, file_fd(-1)
+	, file_offset(0)
+	, file_end(0)
+	, deflater(NULL)
+	{}
+
+	const char *OutputQueue::Segment::bytes() const {
+		return shared.empty() ? data.data() : shared.data();
+	}
+
+	size_t OutputQueue::Segment::length() const {
+		return shared.empty() ? data.size() : shared.size();
+	}
+
+	OutputQueue::OutputQueue()
+	: _segments()
+	, _memory_bytes(0)
+	, _file_count(0)
+	{}
+
+	// the connection went away before its files were sent
+	OutputQueue::~OutputQueue() {
+		while (!_segments.empty()) {
+			_pop_front();
+		}
+	}
+
+	// takes the content of data, leaving it empty
+	void OutputQueue::push_data(std::string &data) {
+		if (data.empty()) {
+			return;
+		}
+		_memory_bytes += data.size();
+		_segments.push_back(Segment());
+		_segments.back().data.swap(data);
+	}
+
+	// shares the buffer, it is released once sent
+	void OutputQueue::push_shared(const Utility::SharedBuffer &buffer) {
+		if (buffer.empty()) {
+			return;
+		}
+		_memory_bytes += buffer.size();
+		_segments.push_back(Segment());
+		_segments.back().shared = buffer;
+	}
+
+	// takes the ownership of file_fd, it is closed once the range is sent
+	void OutputQueue::push_file(int file_fd, off_t offset, off_t end) {
+		if (offset >= end) {
+			close(file_fd);
+			return;
+		}
+		_segments.push_back(Segment());
+		_file_count++;
+		Segment &segment = _segments.back();
+		segment.file_fd = file_fd;
+		segment.file_offset = offset;
+		segment.file_end = end;
+	}
+
+	// takes the ownership of file_fd like push_file, the range goes out as a gzip stream in a chunked body
+	void OutputQueue::push_gzip_file(int file_fd, off_t offset, off_t end, int level) {
+		_segments.push_back(Segment());
+		_file_count++;
+		Segment &segment = _segments.back();
+		segment.file_fd = file_fd;
+		segment.file_offset = offset;
+		segment.file_end = end;
+		segment.deflater = new Utility::Deflater(level);
+	}
+
+	// Sends until the socket is full, the queue is empty or a wakeup's worth of bytes went out, so that
+	// one fast download does not hold up the other connections. Runs of memory segments go out in one
+	// writev, file ranges with sendfile. Returns false if the delegate closed the connection on an error.
+	bool OutputQueue::flush(RequestHandlerDelegate &delegate) {
+		size_t total_sent = 0;
+		while (!_segments.empty() && total_sent < static_cast<size_t>(Constants::SEND_MAX_CHUNK)) {
+			size_t requested = 0;
+			ssize_t bytes_sent;
+			if (_segments.front().file_fd == -1) {
+				bytes_sent = _send_data(delegate, requested);
+			}
+			else if (_segments.front().deflater != NULL) {
+				if (!_deflate_file()) { // the chunked body can't be finished anymore
+					delegate.close();
+					return false;
+				}
+				continue; // the next piece is in front of the file now
+			}
+			else {
+				bytes_sent = _send_file(delegate, requested);
+			}
+			if (bytes_sent == Constants::ERROR) {
+				return false;
+			}
+			total_sent += bytes_sent;
+			if (static_cast<size_t>(bytes_sent) < requested) { // the socket buffer is full, the rest waits for the next write event
+				break;
+			}
+		}
+		return true;
+	}
+
+	bool OutputQueue::empty() const {
+		return _segments.empty();
+	}
+
+	size_t OutputQueue::size() const {
+		return _segments.size();
+	}
+
+	// Nothing more is queued behind a file or past OUTPUT_QUEUE_SIZE bytes until the client read some of it,
+	// so a client that pipelines requests without reading can't make the server hold its responses and fds.
+	bool OutputQueue::is_full() const {
+		return _file_count > 0 || _memory_bytes >= static_cast<size_t>(Constants::OUTPUT_QUEUE_SIZE);
+	}
+
+	ssize_t OutputQueue::_send_data(RequestHandlerDelegate &delegate, size_t &requested) {
+		struct iovec iov[MAX_IOVECS];
+		int iov_count = 0;
+		for (std::deque<Segment>::iterator it = _segments.begin(); it != _segments.end() && it->file_fd == -1 && iov_count < MAX_IOVECS; ++it) {
+			iov[iov_count].iov_base = const_cast<char *>(it->bytes()) + it->data_offset;
+			iov[iov_count].iov_len = it->length() - it->data_offset;
+			requested += iov[iov_count].iov_len;
+			iov_count++;
+		}
+		ssize_t bytes_sent = delegate.send(iov, iov_count);
+		if (bytes_sent == Constants::ERROR) {
+			return bytes_sent;
+		}
+		_memory_bytes -= bytes_sent;
+		size_t left = bytes_sent;
+		while (left > 0) {
+			Segment &segment = _segments.front();
+			size_t segment_left = segment.length() - segment.data_offset;
+			if (left < segment_left) {
+				segment.data_offset += left;
+				break;
+			}
+			left -= segment_left;
+			_pop_front();
+		}
+		return bytes_sent;
+	}
+
+	ssize_t OutputQueue::_send_file(RequestHandlerDelegate &delegate, size_t &requested) {
+		Segment &segment = _segments.front();
+		off_t left = segment.file_end - segment.file_offset;
+		requested = left < Constants::SEND_MAX_CHUNK ? static_cast<size_t>(left) : Constants::SEND_MAX_CHUNK;
+		ssize_t bytes_sent = delegate.send_file(segment.file_fd, segment.file_offset, requested);
+		if (bytes_sent != Constants::ERROR && segment.file_offset >= segment.file_end) {
+			_pop_front();
+		}
+		return bytes_sent;
+	}
+
+	// Compresses the next piece of the file into a chunk put in front of it, the last piece also ends the
+	// gzip stream and the chunked body. A file that got shorter in the meantime ends the stream early.
+	bool OutputQueue::_deflate_file() {
+		Segment &segment = _segments.front();
+		char buffer[Constants::GZIP_READ_SIZE];
+		off_t left = segment.file_end - segment.file_offset;
+		size_t size = left < Constants::GZIP_READ_SIZE ? static_cast<size_t>(left) : Constants::GZIP_READ_SIZE;
+		ssize_t bytes_read = 0;
+		if (size != 0) {
+			bytes_read = pread(segment.file_fd, buffer, size, segment.file_offset);
+		}
+		if (bytes_read == Constants::ERROR) {
+			perror("pread error");
+			return false;
+		}
+		segment.file_offset += bytes_read;
+		bool finish = bytes_read == 0 || segment.file_offset >= segment.file_end;
+		std::string chunk(CHUNK_SIZE_DIGITS, '0'); // the size is written in once it is known
+		chunk.append("\r\n");
+		size_t head_size = chunk.size();
+		if (!segment.deflater->compress(buffer, bytes_read, chunk, finish)) {
+			return false;
+		}
+		size_t chunk_size = chunk.size() - head_size;
+		if (chunk_size == 0) { // zlib keeps the input for now
+			chunk.clear();
+		}
+		else {
+			static const char digits[] = "0123456789abcdef";
+			for (size_t i = CHUNK_SIZE_DIGITS; i > 0; i--, chunk_size >>= 4) {
+				chunk[i - 1] = digits[chunk_size & 0xf];
+			}
+			chunk.append("\r\n");
+		}
+		if (finish) {
+			chunk.append("0\r\n\r\n");
+			_pop_front();
+		}
+		if (!chunk.empty()) {
+			_memory_bytes += chunk.size();
+			_segments.push_front(Segment());
+			_segments.front().data.swap(chunk);
+		}
+		return true;
+	}
+
+	void OutputQueue::_pop_front() {
+		if (_segments.front().file_fd != -1) {
+			close(_segments.front().file_fd);
+			_file_count--;
+		}
+		delete _segments.front().deflater;
+		_segments.pop_front();
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <cstddef>
+#include <sys/types.h> // for off_t
+
+#include "RequestHandlerDelegate.hpp"
+#include "../Utility/SharedBuffer.hpp"
+#include "../Utility/Deflater.hpp"
+
+namespace HTTP {
+	// Everything that still has to go out on a connection, in order: blocks of memory and ranges of files.
+	// Sent bytes only move the offset of their segment, a buffer is never shifted to drop its front.
+	// A file that is gzip compressed on the way is read one piece at a time, once the previous piece is out.
+	class OutputQueue
+	{
+	public:
+		struct Segment
+		{
+			Segment();
+
+			std::string data;
+			Utility::SharedBuffer shared; // sent instead of data when set, e.g. a file from the content cache
+			size_t data_offset; // bytes of data already sent
+			int file_fd; // -1 for a memory segment
+			off_t file_offset;
+			off_t file_end;
+			Utility::Deflater *deflater; // set for a file sent gzip compressed, in chunks
+
+			const char *bytes() const;
+			size_t length() const;
+		};
+
+		OutputQueue();
+		~OutputQueue();
+
+		void push_data(std::string &data);
+		void push_shared(const Utility::SharedBuffer &buffer);
+		void push_file(int file_fd, off_t offset, off_t end);
+		void push_gzip_file(int file_fd, off_t offset, off_t end, int level);
+		bool flush(RequestHandlerDelegate &delegate);
+		bool empty() const;
+		size_t size() const;
+		bool is_full() const;
+
+	private:
+		static const int MAX_IOVECS = 64;
+		static const size_t CHUNK_SIZE_DIGITS = 8; // hex digits of a chunk size, leading zeros are allowed
+
+		std::deque<Segment> _segments;
+		size_t _memory_bytes; // of the memory segments, not sent yet
+		int _file_count;
+
+		OutputQueue(const OutputQueue &other);
+		OutputQueue &operator=(const OutputQueue &other);
+
+		ssize_t _send_data(RequestHandlerDelegate &delegate, size_t &requested);
+		ssize_t _send_file(RequestHandlerDelegate &delegate, size_t &requested);
+		bool _deflate_file();
+		void _pop_front();
+	};
+}
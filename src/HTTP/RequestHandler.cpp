@@ -3,8 +3,9 @@
 #include <sstream> // for converting int to string
 #include <stdio.h> // for perror
 #include <stdlib.h> //for atoi
-#include <sys/event.h>//for kqueue
 #include <unistd.h>
+#include <fcntl.h> // for F_DUPFD_CLOEXEC
+#include <errno.h>
 
 #include "Exceptions/RequestException.hpp"
 #include "../Utility/Utility.hpp"
@@ -21,27 +22,59 @@ namespace HTTP {
 	, response_handler(&_http_request_message, &_http_response_message)
 	, _cgi_handler(_connection_listen_info.port)
 	, response_ready(false)
+	, _keep_alive(false)
+	, _is_idle(true)
+	, _requests_served(0)
+	, _keepalive_timeout(Constants::DEFAULT_KEEPALIVE_TIMEOUT)
+	, _output()
+	, _pipelined_input()
+	, _waiting_for_cgi(false)
+	, _close_after_responses(false)
+	, _reading_paused(false)
 	{
+		_parser.set_delegate(this);
 	}
 
-	RequestHandler::~RequestHandler(){}
+	RequestHandler::~RequestHandler(){
+	}
 
-	void RequestHandler::handle_http_request(int kq, int socket_fd) {
+	void RequestHandler::handle_http_request(EventLoop& event_loop, int socket_fd) {
 		char buf[4096];
 		ssize_t bytes_read = _delegate.receive(buf, sizeof(buf));
 		if (bytes_read == 0) {
 			_delegate.close();
 		} else if (bytes_read == Constants::ERROR) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) // the socket is non-blocking, nothing to read after all
+				return;
 			perror("recv error");
 			_delegate.close();
-		} else {
+		} else if (_pipelined_input.empty() && !_holds_back_requests()) {
+			_handle_received_data(event_loop, socket_fd, buf, bytes_read);
+		} else { // the new bytes go behind the requests already waiting
+			_pipelined_input.insert(_pipelined_input.end(), buf, buf + bytes_read);
+			handle_pipelined_requests(event_loop, socket_fd);
+		}
+	}
+
+	// the next request waits while a CGI response is pending or the client has not read enough of the queued responses
+	bool RequestHandler::_holds_back_requests() const {
+		return _waiting_for_cgi || _output.is_full();
+	}
+
+	// one read can carry several pipelined requests, each of them gets its response queued in order
+	void RequestHandler::_handle_received_data(EventLoop& event_loop, int socket_fd, char* data, size_t size) {
+		size_t bytes_parsed = 0;
+		while (bytes_parsed != size && !_close_after_responses && !_holds_back_requests()) {
+			_is_idle = false;
 			try {
-				_parser.parse_HTTP_request(buf, bytes_read);
+				bytes_parsed += _parser.parse_HTTP_request(data + bytes_parsed, size - bytes_parsed);
 			}
 			catch(const Exception::RequestException& e)
 			{
 				_handle_request_exception(e.get_error_status_code());
 				Utility::logger("Request  [Bad Request]", YELLOW);
+				_keep_alive = false; // the rest of the stream can't be trusted after a malformed request
+				response_handler.set_keep_alive(false);
 				response_handler.handle_error(e.get_error_status_code()); //error response is built, and will be sent below
 				response_ready = true;
 			}
@@ -51,26 +84,114 @@ namespace HTTP {
 			if (!response_ready) { // checking if the response with the error code has been filled
 				if(!_process_http_request(socket_fd)) //this means the cgi is encounted and data prepared
 				{
-					//add writing event
-					struct kevent kev;
-					int write_fd = _cgi_handler.get_write_fd();
-					EV_SET(&kev, write_fd, EVFILT_WRITE, EV_ADD, 0, 0, NULL);
-					if (kevent(kq, &kev, 1, NULL, 0, NULL)<0){
-						fprintf(stderr,"kevent failed.");
-						return;
-					}
+					_waiting_for_cgi = true;
+					event_loop.add_write_event(_cgi_handler.get_write_fd()); //add writing event
 				}
 				else
 					response_ready = true;
 			}
+			if (response_ready)
+				_finish_response();
 		}
+		if (!_close_after_responses && bytes_parsed != size)
+			_pipelined_input.insert(_pipelined_input.begin(), data + bytes_parsed, data + size);
 	}
 
-	void RequestHandler::send_response() {
-		if (response_ready) {
-			std::string& response = _http_response_message.get_complete_response();
-			_delegate.send(response, response.size());
+	// picks up the requests that were held back, once the CGI response or enough of the queued output is out
+	void RequestHandler::handle_pipelined_requests(EventLoop& event_loop, int socket_fd) {
+		if (!_close_after_responses && !_holds_back_requests() && !_pipelined_input.empty()) {
+			std::vector<char> pending;
+			pending.swap(_pipelined_input);
+			_handle_received_data(event_loop, socket_fd, &pending[0], pending.size());
 		}
+		_update_reading(event_loop, socket_fd);
+	}
+
+	// the socket is not read while PIPELINED_INPUT_SIZE bytes of requests are held back
+	void RequestHandler::_update_reading(EventLoop& event_loop, int socket_fd) {
+		bool full = _pipelined_input.size() >= static_cast<size_t>(Constants::PIPELINED_INPUT_SIZE);
+		if (full && !_reading_paused)
+			event_loop.delete_read_event(socket_fd);
+		else if (!full && _reading_paused)
+			event_loop.add_read_event(socket_fd);
+		_reading_paused = full;
+	}
+
+	// the finished response joins the queue, so the handler is free to parse the next request right away
+	void RequestHandler::_finish_response() {
+		std::string body;
+		_http_response_message.swap_message_body(body);
+		_output.push_shared(_http_response_message.get_cached_head());
+		_output.push_data(_http_response_message.get_serialized_head()); // head and body leave together in one writev
+		_output.push_data(body);
+		_output.push_shared(_http_response_message.get_body_buffer());
+		off_t file_size = _http_response_message.get_body_file_size();
+		int file_fd = _http_response_message.release_body_file();
+		if (file_fd != -1 && _http_response_message.get_gzip_level() != 0) // compressed while it goes out
+			_output.push_gzip_file(file_fd, 0, file_size, _http_response_message.get_gzip_level());
+		else if (file_fd != -1)
+			_queue_body_file(file_fd, file_size);
+		if (!_keep_alive)
+			_close_after_responses = true;
+		_waiting_for_cgi = false;
+		_reset();
+	}
+
+	// every range goes out with sendfile from its own copy of the fd, the queue closes them one by one
+	void RequestHandler::_queue_body_file(int file_fd, off_t file_size) {
+		const std::vector<HTTPResponse::BodyRange>& ranges = _http_response_message.get_body_ranges();
+		if (ranges.empty()) {
+			_output.push_file(file_fd, 0, file_size);
+			return;
+		}
+		for (std::vector<HTTPResponse::BodyRange>::const_iterator it = ranges.begin(); it != ranges.end(); ++it) {
+			std::string head(it->head);
+			_output.push_data(head);
+			if (it->start < it->end) {
+				int range_fd = fcntl(file_fd, F_DUPFD_CLOEXEC, 0);
+				if (range_fd == Constants::ERROR) {
+					perror("dup error");
+					_close_after_responses = true; // the Content-Length can't be kept anymore
+					break;
+				}
+				_output.push_file(range_fd, it->start, it->end);
+			}
+		}
+		close(file_fd);
+	}
+
+	void RequestHandler::send_response() {
+		if (_output.empty())
+			return;
+		if (!_output.flush(_delegate)) // the connection is already closed
+			return;
+		if (_output.empty() && _close_after_responses)
+			_delegate.close();
+	}
+
+	// the connection stays open, but every per request state has to start from scratch
+	void RequestHandler::_reset() {
+		_http_request_message.reset();
+		_http_response_message.reset();
+		_parser.reset();
+		response_handler.reset();
+		_cgi_handler.reset();
+		response_ready = false;
+		_keep_alive = false;
+		_is_idle = true;
+	}
+
+	// HTTP/1.1 connections are persistent unless the client opts out, HTTP/1.0 ones only when the client asks for it
+	bool RequestHandler::_should_keep_alive(const Config::ServerBlock *virtual_server) {
+		_requests_served++;
+		_keepalive_timeout = virtual_server->get_keepalive_timeout();
+		if (_keepalive_timeout == 0 || _requests_served >= virtual_server->get_keepalive_requests())
+			return false;
+		if (_http_request_message.get_HTTP_version() == "HTTP/1.1")
+			return !_http_request_message.has_connection_option("close");
+		if (_http_request_message.get_HTTP_version() == "HTTP/1.0")
+			return _http_request_message.has_connection_option("keep-alive");
+		return false;
 	}
 
 	void RequestHandler::_handle_request_exception(HTTPResponse::StatusCode code) {
@@ -89,10 +210,28 @@ namespace HTTP {
 	bool RequestHandler::RequestHandler::_process_http_request(int socket_fd) {
 		const Config::ServerBlock *virtual_server = _find_virtual_server();
 		const Config::LocationBlock *location = _match_most_specific_location(virtual_server);
+		_keep_alive = _should_keep_alive(virtual_server);
+		response_handler.set_keep_alive(_keep_alive);
 		response_handler.set_config_rules(virtual_server, location);
 		return response_handler.create_http_response(_cgi_handler, socket_fd); //FROM here, it's moving to ResponseHandler
 	}
 
+	// same choice between the levels as for the 413 check of the response handler
+	HTTPRequest::BodyLimits RequestHandler::get_body_limits() {
+		const Config::ServerBlock *virtual_server = _find_virtual_server();
+		const Config::LocationBlock *location = _match_most_specific_location(virtual_server);
+		HTTPRequest::BodyLimits limits;
+		if (location && !location->get_is_size_default())
+			limits.max_size = location->get_client_max_body_size();
+		else
+			limits.max_size = virtual_server->get_client_max_body_size();
+		if (location && !location->get_is_buffer_size_default())
+			limits.buffer_size = location->get_client_body_buffer_size();
+		else
+			limits.buffer_size = virtual_server->get_client_body_buffer_size();
+		return limits;
+	}
+
 	const Config::ServerBlock* RequestHandler::_find_virtual_server() {
 		std::vector<const Config::ServerBlock*> matching_servers;
 		for (std::vector<Config::ServerBlock>::const_iterator it = _config_data->get_servers().begin(); it != _config_data->get_servers().end(); it++) {
@@ -113,12 +252,10 @@ namespace HTTP {
 	}
 
 	const Config::ServerBlock* RequestHandler::_match_server_based_on_server_name(std::vector<const Config::ServerBlock*> matching_servers) {
-		std::string host = "";
-		if(_http_request_message.has_header_field("HOST"))
-			host = _http_request_message.get_header_value("HOST"); 
+		Utility::StringView host = _http_request_message.get_host_name();
 		for (std::vector<const Config::ServerBlock*>::iterator it = matching_servers.begin(); it != matching_servers.end(); it++)
 			for (std::vector<std::string>::const_iterator srv_name = (*it)->get_server_name().begin(); srv_name != (*it)->get_server_name().end(); srv_name++)
-				if ((*srv_name).compare(host) == 0)
+				if (host.equals(*srv_name))
 					return *it; // the first one is used even if there might be multiple matches
 		return matching_servers.front(); //returns the default one for that ip + port if multiple servers match ip+port but no match with server_name,
 	}
@@ -158,22 +295,31 @@ namespace HTTP {
 		return _http_response_message;
 	}
 
+	// called once the CGI output (or the error replacing it) is in the response message
 	void RequestHandler::set_response_true(){
+		if (!_waiting_for_cgi)
+			return;
 		response_ready = true;
+		_finish_response();
 	}
 	
 	void RequestHandler::set_cgi_handler(CGI::CGIHandler cgi_handler){
 		_cgi_handler = cgi_handler;
 	}
 
-	void RequestHandler::execute_cgi(int kq){
-		_cgi_handler.execute_cgi(kq);
+	void RequestHandler::execute_cgi(EventLoop& event_loop){
+		_cgi_handler.execute_cgi(event_loop);
 	}
 
 	void RequestHandler::handle_internal_server_error(){
 		response_handler.handle_error(static_cast<HTTPResponse::StatusCode>(500));//500 is the code for internal server error
 	}
 
+	// the config rules of the request are still in place, they decide on compressing the output
+	void RequestHandler::set_cgi_response(std::string &output){
+		response_handler.set_cgi_response(output);
+	}
+
 	int RequestHandler::get_cgi_write_fd() const{
 		return _cgi_handler.get_write_fd();
 	}
@@ -189,4 +335,24 @@ namespace HTTP {
 	bool RequestHandler::get_search_cgi_extention_result() const{
 		return _cgi_handler.get_search_cgi_extention_result();
 	}
+
+	bool RequestHandler::is_idle() const {
+		return _is_idle && !has_pending_response();
+	}
+
+	bool RequestHandler::is_waiting_for_cgi() const {
+		return _waiting_for_cgi;
+	}
+
+	bool RequestHandler::has_pending_response() const {
+		return !_output.empty() || _waiting_for_cgi;
+	}
+
+	bool RequestHandler::has_response_to_send() const {
+		return !_output.empty();
+	}
+
+	int RequestHandler::get_keepalive_timeout() const {
+		return _keepalive_timeout;
+	}
 }
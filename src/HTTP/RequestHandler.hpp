@@ -1,19 +1,23 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "RequestHandlerDelegate.hpp"
 #include "../HTTPRequest/RequestMessage.hpp"
 #include "../HTTPResponse/ResponseMessage.hpp"
 #include "../HTTPRequest/RequestParser.hpp"
+#include "../HTTPRequest/RequestParserDelegate.hpp"
 #include "../HTTPResponse/StatusCodes.hpp"
 #include "../HTTPResponse/ResponseHandler.hpp"
 #include "../config/ConfigData.hpp"
 #include "ServerStructs.hpp"
 #include "../CGI/CGIHandler.hpp"
+#include "EventLoop.hpp"
+#include "OutputQueue.hpp"
 
 namespace HTTP {
-    class RequestHandler
+    class RequestHandler : public HTTPRequest::RequestParserDelegate
     {
     private:
         HTTPRequest::RequestMessage _http_request_message;
@@ -25,10 +29,26 @@ namespace HTTP {
         HTTPResponse::ResponseHandler response_handler;
         CGI::CGIHandler _cgi_handler;
         bool response_ready;
+        bool _keep_alive;
+        bool _is_idle;
+        int _requests_served;
+        int _keepalive_timeout;
+        OutputQueue _output; // finished responses, in the order the pipelined requests came in
+        std::vector<char> _pipelined_input; // bytes of the next requests, received while they are held back
+        bool _waiting_for_cgi;
+        bool _close_after_responses;
+        bool _reading_paused;
 
         void _handle_request_exception(HTTPResponse::StatusCode code);
         const std::string _convert_status_code_to_string(const int code);
         bool _process_http_request(int socket_fd);
+        void _handle_received_data(EventLoop& event_loop, int socket_fd, char* data, size_t size);
+        bool _holds_back_requests() const;
+        void _update_reading(EventLoop& event_loop, int socket_fd);
+        void _finish_response();
+        void _queue_body_file(int file_fd, off_t file_size);
+        bool _should_keep_alive(const Config::ServerBlock *virtual_server);
+        void _reset();
 		const Config::ServerBlock* _find_virtual_server();
 		const Config::ServerBlock* _match_server_based_on_server_name(std::vector<const Config::ServerBlock*> matching_servers);
 		const Config::LocationBlock* _match_most_specific_location(const Config::ServerBlock *server);
@@ -36,15 +56,23 @@ namespace HTTP {
     public:
         RequestHandler(RequestHandlerDelegate& delegate, Config::ConfigData *config_data, ListenInfo& listen_info);
         ~RequestHandler();
-        void handle_http_request(int kq, int socket_fd);
+        HTTPRequest::BodyLimits get_body_limits();
+        void handle_http_request(EventLoop& event_loop, int socket_fd);
+        void handle_pipelined_requests(EventLoop& event_loop, int socket_fd);
         void send_response();
         void set_response_true();
         void set_cgi_handler(CGI::CGIHandler cgi_handler);
-        void execute_cgi(int kq);
+        void execute_cgi(EventLoop& event_loop);
         void handle_internal_server_error();
+        void set_cgi_response(std::string &output);
         int get_cgi_write_fd() const;
         int get_cgi_read_fd() const;
         bool get_search_cgi_extention_result() const;
+        bool is_idle() const;
+        bool is_waiting_for_cgi() const;
+        bool has_pending_response() const;
+        bool has_response_to_send() const;
+        int get_keepalive_timeout() const;
         const std::string get_request_message_body() const;
         HTTPResponse::ResponseMessage &get_http_response_message();
     };
@@ -1,6 +1,9 @@
 #pragma once
 
 #include  <cstddef>
+#include <string>
+#include <sys/types.h> // for off_t
+#include <sys/uio.h> // for iovec
 
 namespace HTTP {
 	class RequestHandlerDelegate {
@@ -9,7 +12,9 @@ namespace HTTP {
 		virtual ~RequestHandlerDelegate() {}
 
 		virtual size_t receive(char *buffer, size_t buffer_size) = 0;
-		virtual void send(std::string& buffer, size_t buffer_size) = 0;
+		// both return the bytes sent, 0 if the socket can't take more right now, ERROR once the connection is closed
+		virtual ssize_t send(const struct iovec *iov, int iov_count) = 0;
+		virtual ssize_t send_file(int file_fd, off_t& offset, size_t count) = 0;
 		virtual int get_fd() = 0;
 		virtual void close() = 0;
 	};
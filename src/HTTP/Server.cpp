@@ -11,13 +11,7 @@
 #include <cstdio> // for perror
 #include <fcntl.h> // for fcntl
 #include <sys/time.h> // for timeout
-#include <sys/stat.h> // for fstat
 #include <csignal>
-#ifdef _LINUX
-	#include "/usr/include/kqueue/sys/event.h" //linux kqueue
-#else
-	#include <sys/event.h> // for kqueue and kevent
-#endif
 
 #include "RequestHandler.hpp"
 #include "../Utility/Utility.hpp"
@@ -27,7 +21,9 @@ namespace HTTP {
 
 	Server::Server(Config::ConfigData *config_data)
 	: config_data(config_data)
-	, _logtime_checker()
+	, _timers(Utility::TimerWheel::now())
+	, _now(Utility::TimerWheel::now())
+	, _event_loop(NULL)
 	{}
 
 	Server::~Server() {
@@ -35,15 +31,16 @@ namespace HTTP {
 		for (; it != _listening_sockfds.end(); ++it) {
 			close(*it); //closing listening sockets
 		}
-		std::map<int, Connection*>::iterator connection_iter = _connections.begin();
-		for (; connection_iter != _connections.end(); ++connection_iter) {
-			if (connection_iter->second->is_connection_open()) {
-				connection_iter->second->close();
-				// Utility::logger("Connection " + Utility::to_string(connection_iter->first) + " closed.", PURPLE); // for debug
+		for (size_t fd = 0; fd < _fd_table.size(); fd++) {
+			if (_fd_table[fd].type != FdEntry::CLIENT) {
+				continue;
 			}
-			connection_iter = _destroy_connection(connection_iter);
+			if (_fd_table[fd].connection->is_connection_open()) {
+				_fd_table[fd].connection->close();
+				// Utility::logger("Connection " + Utility::to_string(fd) + " closed.", PURPLE); // for debug
+			}
+			_destroy_connection(fd);
 		}
-		_connections.clear();
 		std::cout << "server gracefully stopped\n";
 	}
 
@@ -54,10 +51,21 @@ namespace HTTP {
 	// 	exit(signum);
 	// }
 
-	void Server::run() {
-		// signal(SIGINT, signalHandler); // for leaks debug
+	// Binds the listening sockets. A master process calls it before forking its workers, which inherit the sockets.
+	void Server::setup_listeners() {
 		_setup_listening_ports();
 		_setup_listening_sockets();
+	}
+
+	void Server::run() {
+		// signal(SIGINT, signalHandler); // for leaks debug
+		if (_listening_sockfds.empty()) {
+			setup_listeners();
+		}
+		// Created here and not in the constructor, so that every forked worker gets its own
+		_event_loop.reset(EventLoop::create(config_data->get_event_batch_size(), config_data->get_event_backend()));
+		std::signal(SIGCHLD, SIG_IGN); // CGI children are reaped by the kernel, nobody waits for them
+		std::signal(SIGPIPE, SIG_IGN); // a client that leaves in the middle of a download is an error of that send, not the end of the server
 		_handle_events();
 	}
 
@@ -95,6 +103,12 @@ namespace HTTP {
 				Utility::logger("Setting SO_REUSEADDR failed. errno: " + Utility::to_string(errno), RED);
 				std::exit(EXIT_FAILURE);
 			}
+			// With several worker threads every event loop binds its own socket to the same port,
+			// and the kernel spreads the incoming connections between them.
+			if (config_data->get_worker_threads() > 1 && setsockopt(_listening_sockfds[i], SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value)) < 0) {
+				Utility::logger("Setting SO_REUSEPORT failed. errno: " + Utility::to_string(errno), RED);
+				std::exit(EXIT_FAILURE);
+			}
 			sockaddr_in sockaddr;
 			sockaddr.sin_family = AF_INET;
 			sockaddr.sin_addr.s_addr = htonl(INADDR_ANY);// this is the address for this socket. The special adress for this is 0.0.0.0, defined by symbolic constant INADDR_ANY
@@ -110,257 +124,274 @@ namespace HTTP {
 			if (fcntl(_listening_sockfds[i], F_SETFL, O_NONBLOCK) == Constants::ERROR) {
 				std::perror("fcntl error");
 			}
+			if (fcntl(_listening_sockfds[i], F_SETFD, FD_CLOEXEC) == Constants::ERROR) { // CGI children must not inherit it
+				std::perror("fcntl error");
+			}
 			ListenInfo each_listen("0.0.0.0", _listen_ports[i]); //this struct will hold both ip and port info of running servers
 			_running_servers[_listening_sockfds[i]] = each_listen;
+			FdEntry& entry = _fd_entry(_listening_sockfds[i]);
+			entry.type = FdEntry::LISTENER;
+			entry.listen_info = &_running_servers[_listening_sockfds[i]];
 			Utility::logger("Server listening on port: " + Utility::to_string(_listen_ports[i]), MAGENTA);
 		}
 	}
 
 	void Server::_handle_events() {
-		int new_events = 0;
-		int sock_kqueue = kqueue(); //creates a new kernel event queue and returns a descriptor.
-		if (sock_kqueue < 0) {
-			Utility::logger("Error creating kqueue. errno: "  +  Utility::to_string(errno), RED);
-			std::exit(EXIT_FAILURE);
-		}
-		struct kevent kev, event_fds; // First - kernel events we want to monitor, second - events triggered
+		Utility::logger("Event loop: " + _event_loop->get_name(), MAGENTA);
 		for(size_t i = 0; i < _listen_ports.size(); i++) {
-			// Prepare a read event:
-			EV_SET(&kev, _listening_sockfds[i], EVFILT_READ, EV_ADD | EV_ENABLE, 0, 0, 0); // is a macro which is provided for ease of initializing a kevent structure.
-			// Register an event:
-			if (kevent(sock_kqueue, &kev, 1, NULL, 0, NULL) < 0) {
-				std::perror("kevent");
-				std::exit(1);
-			}
+			_event_loop->add_read_event(_listening_sockfds[i]);
 		}
 		while (true) {
-			struct timespec timeout;
-			timeout.tv_sec = 30;
-			timeout.tv_nsec = 0;
-			// Receive events:
-			new_events = kevent(sock_kqueue, NULL, 0, &event_fds, 1, &timeout); //look out for events and register to event list; one event per time
+			// Submit the pending changes and receive a batch of events, waking up in time for the next timeout:
+			int new_events = _event_loop->wait(_timers.next_timeout());
 			if(new_events == Constants::ERROR) {
+				if (errno == EINTR)
+					continue;
 				std::cerr << "it is caused by new events register failure \n";
-				std::perror("kevent");
+				std::perror("event loop");
 				exit(1);
 			}
-			_close_hanging_connections(sock_kqueue);
+			_now = Utility::TimerWheel::now();
+			_close_hanging_connections();
 			for (int i = 0; i < new_events; i++)
 			{
-				int current_event_fd = event_fds.ident;
-				if (event_fds.flags & EV_ERROR) {
-					std::cout << "Event error: %s", strerror(event_fds.data);
-					std::exit(EXIT_FAILURE);
+				const EventLoop::Event& event = _event_loop->get_event(i);
+				int current_event_fd = event.fd;
+				if (_event_loop->is_forgotten(current_event_fd)) { // closed by an earlier event of this batch
+					continue;
+				}
+				FdEntry::Type type = _fd_entry(current_event_fd).type;
+				if (event.error) { // a change of the previous iteration could not be applied
+					Utility::logger("Event error on fd " + Utility::to_string(current_event_fd) + ": " + strerror(event.error), RED);
 				}
-				else if (event_fds.flags & EV_EOF) {
+				else if (type == FdEntry::CGI_PIPE) { // eof on a pipe is the end of the CGI output, read like the rest of it
+					if (event.filter == EventLoop::READ)
+						_handle_read_end_of_pipe(current_event_fd);
+					else
+						_handle_write_end_of_pipe(current_event_fd);
+				}
+				else if (event.eof) {
 					_handle_disconnected_client(current_event_fd);
 				}
-				else if(_is_in_listen_sockfd_list(current_event_fd)) { // if a new client is establishing a connection
-					_accept_new_connection(current_event_fd, sock_kqueue);
+				else if (type == FdEntry::LISTENER) { // if a new client is establishing a connection
+					_accept_new_connection(current_event_fd);
 				}
-				else if (event_fds.filter == EVFILT_READ) { // if a read event is coming
-					_handle_read_event(current_event_fd, sock_kqueue);
+				else if (event.filter == EventLoop::READ) { // if a read event is coming
+					_handle_read_event(current_event_fd);
 				}
-				else if (event_fds.filter == EVFILT_WRITE) {
-					_handle_write_event(current_event_fd, sock_kqueue);
+				else if (event.filter == EventLoop::WRITE) {
+					_handle_write_event(current_event_fd);
 				}
 			}
 		}
 	}
 
-	bool Server::_is_in_listen_sockfd_list(int fd) {
-		for(size_t i = 0; i < _listening_sockfds.size(); i++) {
-			if(fd == _listening_sockfds[i]) {
-				return true;
+	// fds are small and dense, so the table is indexed by them and grows with the highest one seen
+	Server::FdEntry& Server::_fd_entry(int fd) {
+		if (static_cast<size_t>(fd) >= _fd_table.size()) {
+			_fd_table.resize(fd + 1);
+		}
+		return _fd_table[fd];
+	}
+
+	// the pipes of a CGI that has just been started point to their connection, so that their events go straight to it
+	void Server::_track_cgi_pipes(Connection *connection) {
+		int pipe_fds[2] = {connection->get_cgi_write_fd(), connection->get_cgi_read_fd()};
+		for (int i = 0; i < 2; i++) {
+			if (pipe_fds[i] == -1) {
+				continue;
 			}
+			FdEntry& entry = _fd_entry(pipe_fds[i]);
+			entry.type = FdEntry::CGI_PIPE;
+			entry.connection = connection;
 		}
-		return false;
 	}
 
-	void Server::_delete_events(int sock_kqueue, int identifier) {
-		struct kevent kev;
-		EV_SET(&kev, identifier, EVFILT_READ, EV_DELETE, 0, 0, NULL);
-		kevent(sock_kqueue, &kev, 1, NULL, 0, NULL);
-		EV_SET(&kev, identifier, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
-		kevent(sock_kqueue, &kev, 1, NULL, 0, NULL);
+	void Server::_release_cgi_pipe(int pipe_fd) {
+		_event_loop->forget(pipe_fd);
+		close(pipe_fd);
+		_fd_table[pipe_fd] = FdEntry();
 	}
 
-	void Server::_close_hanging_connections(int sock_kqueue) {
-		if (!(_logtime_checker.should_check_hanging_connections())) {
-			return;
+	// the pipes of a connection that goes away (or whose CGI failed) must not deliver events to it anymore
+	void Server::_release_cgi_pipes(Connection *connection) {
+		int pipe_fds[2] = {connection->get_cgi_write_fd(), connection->get_cgi_read_fd()};
+		for (int i = 0; i < 2; i++) {
+			if (pipe_fds[i] != -1 && _fd_entry(pipe_fds[i]).type == FdEntry::CGI_PIPE && _fd_table[pipe_fds[i]].connection == connection) {
+				_release_cgi_pipe(pipe_fds[i]);
+			}
 		}
-		std::map<int, Connection*>::iterator iter = _connections.begin();
-		while (iter != _connections.end()) {
-			if (iter->second->is_hanging_connection()) {
-#ifdef _LINUX // manually removing an event from the kqueue as linux is not deleting it when a socket is closed
-				_delete_events(sock_kqueue, iter->first);
-#endif
-				if (iter->second->is_connection_open()) {
-					iter->second->close();
-					Utility::logger("Connection " + Utility::to_string(iter->first) + " closed on timeout.", PURPLE); // for debug
-				}
-				iter = _destroy_connection(iter);
-			} else {
-				++iter;
+		connection->set_cgi_write_fd(-1);
+		connection->set_cgi_read_fd(-1);
+	}
+
+	void Server::_close_hanging_connections() {
+		std::vector<Utility::TimerWheel::Timer*> expired;
+		_timers.advance(_now, expired);
+		for (size_t i = 0; i < expired.size(); i++) {
+			int fd = expired[i]->id;
+			if (_fd_entry(fd).type != FdEntry::CLIENT) {
+				continue;
 			}
+			if (_fd_table[fd].connection->is_connection_open()) {
+				_fd_table[fd].connection->close();
+				Utility::logger("Connection " + Utility::to_string(fd) + " closed on timeout.", PURPLE); // for debug
+			}
+			_destroy_connection(fd);
 		}
-		_logtime_checker.update_last_activity_logtime();
+	}
+
+	// every activity on a connection pushes its timeout back, an idle one waits for keepalive_timeout
+	void Server::_reset_timeout(Connection *connection) {
+		_timers.schedule(connection->get_timer(), _now + connection->get_timeout());
 	}
 
 	void Server::_handle_disconnected_client(int current_event_fd) {
 		Utility::logger("The client " + Utility::to_string(current_event_fd) + " has disconnected.", BLUE);
 		close(current_event_fd);
+		_event_loop->forget(current_event_fd);
 		_remove_disconnected_client(current_event_fd);
-		Utility::logger("FD " + Utility::to_string(current_event_fd) + " is closed and removed from _connections." , BLUE);
+		Utility::logger("FD " + Utility::to_string(current_event_fd) + " is closed and removed from the fd table." , BLUE);
 	}
 
 	void Server::_remove_disconnected_client(int fd) {
-		std::map<int, Connection*>::iterator disconnected_client = _connections.find(fd);
-		_destroy_connection(disconnected_client);
+		if (_fd_entry(fd).type == FdEntry::CLIENT)
+			_destroy_connection(fd);
+		else
+			_fd_table[fd] = FdEntry();
 	}
 
-	std::map<int, Connection*>::iterator Server::_destroy_connection(std::map<int, Connection*>::iterator iterator) {
-		delete iterator->second;
-		return _connections.erase(iterator);
+	void Server::_destroy_connection(int fd) {
+		Connection* connection = _fd_table[fd].connection;
+		_event_loop->forget(fd);
+		_timers.cancel(connection->get_timer());
+		_release_cgi_pipes(connection);
+		delete connection;
+		_fd_table[fd] = FdEntry();
 	}
 
-	void update_response_message(HTTPResponse::ResponseMessage& _http_response_message, std::string &response){
-		//to remove the content type from the message body when calculating the message body length
-		std::string final_response;
-		std::size_t position = response.find("\r\n\r\n");
-		std::string message_body =response;
-		if(position != std::string::npos){
-			message_body = response.substr(position + 4);
-		}
-		//set any remaining headers
-		_http_response_message.set_header_element("Server", "HungerWeb/1.0");
-		_http_response_message.set_header_element("Date", Utility::get_formatted_date());
-		_http_response_message.set_header_element("Content-Length", Utility::to_string(message_body.length()));
-		// build status line
-		final_response += _http_response_message.get_HTTP_version() + " ";
-		final_response += "200 ";
-		final_response += "OK\r\n";
-		// add all the headers to response. Format is {Header}: {Header value} \r\n
-		for (std::map<std::string, std::string>::const_iterator it = _http_response_message.get_response_headers().begin(); it != _http_response_message.get_response_headers().end(); it++) {
-			if (!it->first.empty())
-				final_response += it->first + ": " + it->second;
-			final_response += "\r\n";
-		}
-		final_response += response;
-		_http_response_message.append_complete_response(final_response);
-	}
-
-	void Server::_accept_new_connection(int current_event_fd, int sock_kqueue) {
+	void Server::_accept_new_connection(int current_event_fd) {
 		sockaddr_in connection_addr;
 		int connection_addr_len = sizeof(connection_addr);
 		int connection_socket_fd = accept(current_event_fd, (struct sockaddr *)&connection_addr, (socklen_t *)&connection_addr_len);
 		if (connection_socket_fd == Constants::ERROR) {
-			std::perror("accept socket error");
+			if (errno != EAGAIN && errno != EWOULDBLOCK) { // another worker process was faster to take the connection
+				std::perror("accept socket error");
+			}
+			return;
 		}
-		std::map<int, Connection *>::iterator it = _connections.find(connection_socket_fd);
-		if (it != _connections.end()) {
-			_destroy_connection(it);
+		if (fcntl(connection_socket_fd, F_SETFL, O_NONBLOCK) == Constants::ERROR) { // a full send buffer must not stall the whole server
+			std::perror("fcntl error");
+		}
+		if (fcntl(connection_socket_fd, F_SETFD, FD_CLOEXEC) == Constants::ERROR) { // CGI children must not inherit it
+			std::perror("fcntl error");
+		}
+		if (_fd_entry(connection_socket_fd).type == FdEntry::CLIENT) { // a stale connection whose fd was closed behind our back
+			_destroy_connection(connection_socket_fd);
 		}
 
-		Connection* connection_ptr = new Connection(connection_socket_fd, config_data, _running_servers[current_event_fd], connection_addr);
-		_connections.insert(std::make_pair(connection_socket_fd, connection_ptr));
-		Utility::logger("New connection " + Utility::to_string(connection_socket_fd) + " on port: " + Utility::to_string(_running_servers[current_event_fd].port), MAGENTA);
+		ListenInfo& listen_info = *_fd_table[current_event_fd].listen_info;
+		Connection* connection_ptr = new Connection(connection_socket_fd, config_data, listen_info, connection_addr);
+		FdEntry& entry = _fd_table[connection_socket_fd];
+		entry.type = FdEntry::CLIENT;
+		entry.connection = connection_ptr;
+		_reset_timeout(connection_ptr);
+		Utility::logger("New connection " + Utility::to_string(connection_socket_fd) + " on port: " + Utility::to_string(listen_info.port), MAGENTA);
 
-		// Register a read events for the client:
-		struct kevent kev;
-		EV_SET(&kev, connection_socket_fd, EVFILT_READ, EV_ADD, 0, 0, NULL); // put socket connection into the filter
-		if (kevent(sock_kqueue, &kev, 1, NULL, 0, NULL) < 0) {
-			std::perror("kevent error - read");
-		}
+		// Register a read events for the client, submitted with the next wait:
+		_event_loop->add_read_event(connection_socket_fd);
 	}
 
-	void Server::_handle_read_event(int current_event_fd, int sock_kqueue) {
-		std::map<int, Connection*>::iterator connection_iter = _connections.find(current_event_fd);
-		if(connection_iter == _connections.end()) { // if the current fd is not the connection socket fd
-			_handle_read_end_of_pipe();
-		}
-		else {
-			(connection_iter->second)->handle_http_request(sock_kqueue);
-			// Register write events for the client
-			struct kevent kev;
-			EV_SET(&kev, connection_iter->first, EVFILT_WRITE, EV_ADD, 0, 0, NULL); // is a macro which is provided for ease of initializing a kevent structure.
-			if (kevent(sock_kqueue, &kev, 1, NULL, 0, NULL) < 0) {
-				std::perror("kevent error - write");
+	void Server::_handle_read_event(int current_event_fd) {
+		const FdEntry& entry = _fd_entry(current_event_fd);
+		if (entry.type == FdEntry::CLIENT) {
+			Connection* connection = entry.connection;
+			connection->handle_http_request(*_event_loop);
+			if (!(connection->is_connection_open())) { // the client closed a persistent connection
+				_destroy_connection(current_event_fd);
+				return;
+			}
+			_track_cgi_pipes(connection);
+			_reset_timeout(connection);
+			if (!(connection->has_response_to_send())) { // the request is not complete yet, or waits for its CGI
+				return;
 			}
+			// Register write events for the client
+			_event_loop->add_write_event(current_event_fd);
 		}
 	}
 
-	void Server::_handle_write_event(int current_event_fd, int sock_kqueue) {
-		std::map<int, Connection*>::iterator connection_iter = _connections.find(current_event_fd);
-		if (connection_iter != _connections.end()) { // handling request by the corresponding connection
-			connection_iter->second->send_response();
-			if (!(connection_iter->second->is_connection_open())) {
-				_destroy_connection(connection_iter);
+	void Server::_handle_write_event(int current_event_fd) {
+		const FdEntry& entry = _fd_entry(current_event_fd);
+		if (entry.type == FdEntry::CLIENT) { // handling request by the corresponding connection
+			Connection* connection = entry.connection;
+			connection->send_response(*_event_loop);
+			if (!(connection->is_connection_open())) {
+				_destroy_connection(current_event_fd);
+			}
+			else {
+				_track_cgi_pipes(connection);
+				_reset_timeout(connection);
+				if (!(connection->has_response_to_send())) { // all queued responses are out, nothing to write until the next request or the CGI output comes in
+					_event_loop->delete_write_event(current_event_fd);
+				}
 			}
 		}
+	}
+
+	// The output of the CGI is collected as it comes, the response is built once the child closed its end.
+	void Server::_handle_read_end_of_pipe(int pipe_fd) {
+		Connection* connection = _fd_table[pipe_fd].connection;
+		char buffer[Constants::CGI_READ_BUFFER_SIZE];
+		ssize_t rt = read(pipe_fd, buffer, sizeof(buffer));
+		if (rt > 0) {
+			connection->append_cgi_output(buffer, rt);
+			return;
+		}
+		_release_cgi_pipe(pipe_fd);
+		if (rt < 0) {
+			std::perror("read");
+			connection->handle_internal_server_error();
+		}
 		else {
-			_handle_write_end_of_pipe(sock_kqueue);
+			connection->set_cgi_response(connection->get_cgi_output());
 		}
+		_finish_cgi(connection);
 	}
 
-	void Server::_handle_read_end_of_pipe() {
-		struct stat sb;
-		std::string response;
-		std::string final_response;
-		std::map<int, Connection*>::iterator it;
-		for(it = _connections.begin(); it != _connections.end(); it++){
-			int read_fd = it->second->get_cgi_read_fd();
-			if(read_fd != -1) {
-				if(fstat(read_fd, &sb) < 0){
-					std::perror("fstat");
-					it->second->handle_internal_server_error();
-					it->second->set_response_true();//set the response ready to be send to client (500 error page)
-				}
-				response.resize(sb.st_size);
-				int rt = read(read_fd, (char*)(response.data()), sb.st_size);
-				if(rt < 0){
-					std::perror("read");
-					it->second->handle_internal_server_error();	
-					it->second->set_response_true();//set the response ready to be send to client (500 error page)
-					close(read_fd);
-				}
-				HTTPResponse::ResponseMessage& _http_response = it->second->get_response_message();
-				update_response_message(_http_response, response);
-				it->second->set_response_true();// set the flag to true
-				break;
+	void Server::_handle_write_end_of_pipe(int pipe_fd) {
+		Connection* connection = _fd_table[pipe_fd].connection;
+		// at most CGI_PIPE_BODY_SIZE bytes, which the non-blocking pipe takes in one write (a bigger body
+		// reaches the child through a file and nothing is left for the pipe)
+		std::string request_message_body = connection->get_request_message_body();
+		ssize_t rt = write(pipe_fd, request_message_body.c_str(), request_message_body.size());
+		_release_cgi_pipe(pipe_fd); // the child sees the end of its input
+		connection->set_cgi_write_fd(-1);
+		if (rt < 0) {
+			Utility::logger("Writing the CGI input failed. errno: " + Utility::to_string(errno), RED);
+		}
+		else if (static_cast<size_t>(rt) < request_message_body.size()) {
+			Utility::logger("Writing the CGI input failed, only " + Utility::size_to_string(rt) + " of " + Utility::size_to_string(request_message_body.size()) + " bytes went into the pipe", RED);
+		}
+		else{
+			try{
+				connection->execute_cgi(*_event_loop);
+				return;
+			}
+			catch(std::exception &e){
 			}
 		}
+		connection->handle_internal_server_error();
+		_finish_cgi(connection); // the 500 error page replaces the CGI output
 	}
 
-	void Server::_handle_write_end_of_pipe(int sock_kqueue) {
-		std::map<int, Connection *>::iterator it;
-		for(it = _connections.begin(); it != _connections.end(); it++){
-			int write_fd = it->second->get_cgi_write_fd();
-			if(write_fd != -1){
-				std::string request_message_body = it->second->get_request_message_body();
-				int rt = write(write_fd, request_message_body.c_str(), request_message_body.size());
-				if(rt < 0){
-					std::perror("write error");
-					it->second->handle_internal_server_error();
-					it->second->set_response_true();//set the response ready to be send to client (500 error page)
-				}
-				else if(rt == 0 && request_message_body.size() != 0){//when the request message body size is zero write will return 0
-					std::perror("write fd undefined");
-					it->second->handle_internal_server_error();
-					it->second->set_response_true();//set the response ready to be send to client (500 error page)
-				}
-				else{
-					try{
-						it->second->execute_cgi(sock_kqueue);	
-					}
-					catch(std::exception &e){
-						it->second->handle_internal_server_error();
-						it->second->set_response_true();//set the response ready to be send to client (500 error page)
-					}
-				}
-				close(write_fd);
-				it->second->set_cgi_write_fd(-1);
-			}
+	// the response is ready, whatever happened to the CGI
+	void Server::_finish_cgi(Connection *connection) {
+		_release_cgi_pipes(connection);
+		connection->get_cgi_output().clear();
+		connection->set_response_true();
+		if (connection->has_response_to_send()) {
+			_event_loop->add_write_event(connection->get_fd());
 		}
 	}
 
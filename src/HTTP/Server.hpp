@@ -6,40 +6,60 @@
 #include <cstdlib>
 #include <cstring>
 #include "Connection.hpp"
+#include "EventLoop.hpp"
 #include "../config/ConfigData.hpp"
 #include "ServerStructs.hpp"
+#include "../Utility/TimerWheel.hpp"
 
 namespace HTTP {
 
 	class Server{
 
 	private:
+		// What an fd reported by the event loop is, looked up by the fd itself
+		struct FdEntry {
+			enum Type { NONE, LISTENER, CLIENT, CGI_PIPE };
+
+			FdEntry() : type(NONE), connection(NULL), listen_info(NULL) {}
+
+			Type type;
+			Connection* connection; // for CLIENT and the CGI_PIPE it owns
+			ListenInfo* listen_info; // for LISTENER
+		};
+
 		Config::ConfigData* config_data;
-		Utility::LogTimeCounter _logtime_checker;
+		Utility::TimerWheel _timers;
+		time_t _now; // loop time, read once per wait
+		Utility::SmartPointer<EventLoop> _event_loop;
 
 		void _handle_events();
 		void _setup_listening_sockets();
-		bool _is_in_listen_sockfd_list(int fd);
+		FdEntry& _fd_entry(int fd);
+		void _track_cgi_pipes(Connection *connection);
 		void _setup_listening_ports();
 		void _handle_disconnected_client(int current_event_fd);
 		void _remove_disconnected_client(int fd);
-		void _close_hanging_connections(int sock_kqueue);
-		void _accept_new_connection(int current_event_fd, int sock_kqueue);
-		void _handle_read_event(int current_event_fd, int sock_kqueue);
-		void _handle_write_event(int current_event_fd, int sock_kqueue);
-		void _handle_read_end_of_pipe();
-		void _handle_write_end_of_pipe(int sock_kqueue);
-		void _delete_events(int sock_kqueue, int identifier);
-		std::map<int, Connection*>::iterator _destroy_connection(std::map<int, Connection *>::iterator iterator);
+		void _close_hanging_connections();
+		void _reset_timeout(Connection *connection);
+		void _accept_new_connection(int current_event_fd);
+		void _handle_read_event(int current_event_fd);
+		void _handle_write_event(int current_event_fd);
+		void _handle_read_end_of_pipe(int pipe_fd);
+		void _handle_write_end_of_pipe(int pipe_fd);
+		void _finish_cgi(Connection *connection);
+		void _release_cgi_pipe(int pipe_fd);
+		void _release_cgi_pipes(Connection *connection);
+		void _destroy_connection(int fd);
 
 		std::vector<int> _listen_ports;
 		std::vector<int> _listening_sockfds;
-		std::map<int, Connection*> _connections;
+		std::vector<FdEntry> _fd_table;
 		std::map<int, ListenInfo> _running_servers;
 
 	public:
 		Server(Config::ConfigData *config_data);
 		~Server();
+		void setup_listeners();
 		void run();
 	};
 }
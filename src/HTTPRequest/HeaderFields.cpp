@@ -0,0 +1,46 @@
+#include "HeaderFields.hpp"
+
+#include <strings.h> // for strncasecmp
+#include <cstring> // for strlen
+
+namespace HTTPRequest {
+
+    namespace {
+        struct KnownHeader {
+            const char* name;
+            const char* key;
+        };
+
+        // in the order of HeaderId
+        const KnownHeader known_headers[KNOWN_HEADER_COUNT] = {
+            {"Host", "HOST"},
+            {"Connection", "CONNECTION"},
+            {"Content-Length", "CONTENT_LENGTH"},
+            {"Transfer-Encoding", "TRANSFER_ENCODING"},
+            {"Content-Type", "CONTENT_TYPE"},
+            {"Content-Disposition", "CONTENT_DISPOSITION"},
+            {"Trailer", "TRAILER"},
+            {"Accept-Encoding", "ACCEPT_ENCODING"},
+            {"Range", "RANGE"},
+            {"If-Range", "IF_RANGE"},
+            {"If-None-Match", "IF_NONE_MATCH"},
+            {"If-Modified-Since", "IF_MODIFIED_SINCE"},
+            {"Authorization", "AUTHORIZATION"}
+        };
+    }
+
+    // the length rules out nearly every candidate before any character is compared
+    HeaderId resolve_header_id(const Utility::StringView& name) {
+        for (int id = 0; id < KNOWN_HEADER_COUNT; ++id) {
+            const char* known_name = known_headers[id].name;
+            if (strlen(known_name) == name.size() && strncasecmp(known_name, name.data(), name.size()) == 0) {
+                return static_cast<HeaderId>(id);
+            }
+        }
+        return HEADER_OTHER;
+    }
+
+    const char* header_key(HeaderId id) {
+        return known_headers[id].key;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef HEADERFIELDS_HPP
+#define HEADERFIELDS_HPP
+
+#include "../Utility/StringView.hpp"
+
+namespace HTTPRequest {
+
+    // The header fields the server acts on. The parser resolves the name of every field once,
+    // so looking one of them up afterwards is an index into the header table of the message.
+    enum HeaderId {
+        HEADER_HOST,
+        HEADER_CONNECTION,
+        HEADER_CONTENT_LENGTH,
+        HEADER_TRANSFER_ENCODING,
+        HEADER_CONTENT_TYPE,
+        HEADER_CONTENT_DISPOSITION,
+        HEADER_TRAILER,
+        HEADER_ACCEPT_ENCODING,
+        HEADER_RANGE,
+        HEADER_IF_RANGE,
+        HEADER_IF_NONE_MATCH,
+        HEADER_IF_MODIFIED_SINCE,
+        HEADER_AUTHORIZATION,
+        KNOWN_HEADER_COUNT,
+        HEADER_OTHER = KNOWN_HEADER_COUNT
+    };
+
+    // case-insensitive, HEADER_OTHER for any field without an id
+    HeaderId resolve_header_id(const Utility::StringView& name);
+    // the name as it is stored in the message: CONTENT_LENGTH for Content-Length
+    const char* header_key(HeaderId id);
+}
+
+#endif
@@ -0,0 +1,258 @@
+#include "MultipartParser.hpp"
+
+#include <cstring> // for memchr, memcmp
+#include <strings.h> // for strcasecmp
+
+#include "../Utility/StringView.hpp"
+#include "../Constants.hpp"
+
+namespace HTTPRequest {
+
+    namespace {
+        // the part of value from start to end (or its end) without the whitespace around it
+        std::string get_trimmed(const std::string& value, size_t start, size_t end) {
+            if (end > value.size()) {
+                end = value.size();
+            }
+            return Utility::StringView(value.data() + start, end - start).trim().str();
+        }
+
+        // the value of a parameter of a header like Content-Disposition: form-data; name="file"; filename="a.png"
+        std::string get_parameter(const std::string& value, const char* key) {
+            size_t position = value.find(';');
+            while (position != std::string::npos) {
+                size_t equals = value.find('=', position + 1);
+                if (equals == std::string::npos) {
+                    return "";
+                }
+                std::string name = get_trimmed(value, position + 1, equals);
+                std::string parameter;
+                size_t end = equals + 1;
+                if (end < value.size() && value[end] == '"') { // a quoted string may hold ';' and escaped characters
+                    for (end++; end < value.size() && value[end] != '"'; end++) {
+                        if (value[end] == '\\' && end + 1 < value.size()) {
+                            end++;
+                        }
+                        parameter += value[end];
+                    }
+                    end = value.find(';', end);
+                }
+                else {
+                    end = value.find(';', end);
+                    parameter = get_trimmed(value, equals + 1, end);
+                }
+                if (strcasecmp(name.c_str(), key) == 0) {
+                    return parameter;
+                }
+                position = end;
+            }
+            return "";
+        }
+    }
+
+    // The first delimiter of the body has no CRLF in front of it: it is made up for by starting with
+    // one held back, and the preamble (usually empty) is thrown away.
+    MultipartParser::MultipartParser(const std::string& boundary, MultipartParserDelegate& delegate)
+        : _delegate(delegate)
+        , _delimiter("\r\n--" + boundary)
+        , _state(PREAMBLE)
+        , _carry("\r\n")
+        , _line("")
+        , _part() {
+        size_t last = _delimiter.size() - 1;
+        for (size_t i = 0; i < 256; i++) {
+            _skip[i] = _delimiter.size();
+        }
+        for (size_t i = 0; i < last; i++) {
+            _skip[static_cast<unsigned char>(_delimiter[i])] = last - i;
+        }
+        _carry.reserve(_delimiter.size());
+    }
+
+    MultipartParser::~MultipartParser() {}
+
+    // false once the body turned out to be malformed or the delegate gave up, the rest is not looked at
+    bool MultipartParser::feed(const char* data, size_t size) {
+        while (size > 0 && _state != FINISHED && _state != FAILED) {
+            size_t used;
+            if (_state == PREAMBLE || _state == CONTENT) {
+                used = _parse_content(data, size);
+            }
+            else {
+                used = _parse_line(data, size);
+            }
+            data += used;
+            size -= used;
+        }
+        return _state != FAILED;
+    }
+
+    // true once the closing delimiter was there, whatever comes after it is the epilogue
+    bool MultipartParser::is_finished() const {
+        return _state == FINISHED;
+    }
+
+    bool MultipartParser::is_failed() const {
+        return _state == FAILED;
+    }
+
+    size_t MultipartParser::_parse_content(const char* data, size_t size) {
+        if (!_carry.empty()) { // a delimiter may start in the held back bytes and go on in this piece
+            for (size_t i = 0; i < _carry.size(); i++) {
+                size_t held = _carry.size() - i;
+                if (_carry.compare(i, held, _delimiter, 0, held) != 0) {
+                    continue;
+                }
+                size_t missing = _delimiter.size() - held;
+                size_t available = missing < size ? missing : size;
+                if (std::memcmp(data, _delimiter.data() + held, available) != 0) {
+                    continue;
+                }
+                if (!_emit(_carry.data(), i)) {
+                    return size;
+                }
+                if (available < missing) { // still only the start of a delimiter
+                    _carry.erase(0, i);
+                    _carry.append(data, size);
+                    return size;
+                }
+                _carry.clear();
+                _handle_delimiter();
+                return missing;
+            }
+            if (!_emit(_carry.data(), _carry.size())) {
+                return size;
+            }
+            _carry.clear();
+        }
+        size_t position = _find_delimiter(data, size);
+        if (position == size) {
+            size_t held = _delimiter_prefix_length(data, size);
+            if (_emit(data, size - held)) {
+                _carry.assign(data + size - held, held);
+            }
+            return size;
+        }
+        if (_emit(data, position)) {
+            _handle_delimiter();
+        }
+        return position + _delimiter.size();
+    }
+
+    // Horspool: the last byte of the window decides how far the delimiter can move on, mostly its
+    // whole length since content bytes rarely occur in it
+    size_t MultipartParser::_find_delimiter(const char* data, size_t size) const {
+        const char* delimiter = _delimiter.data();
+        size_t length = _delimiter.size();
+        size_t last = length - 1;
+        size_t i = 0;
+        while (i + length <= size) {
+            unsigned char character = data[i + last];
+            if (character == static_cast<unsigned char>(delimiter[last]) && std::memcmp(data + i, delimiter, last) == 0) {
+                return i;
+            }
+            i += _skip[character];
+        }
+        return size;
+    }
+
+    // the longest end of the piece that is the start of the delimiter, it can only be told with the next piece
+    size_t MultipartParser::_delimiter_prefix_length(const char* data, size_t size) const {
+        size_t length = size < _delimiter.size() - 1 ? size : _delimiter.size() - 1;
+        for (; length > 0; length--) {
+            if (data[size - length] == '\r' && std::memcmp(data + size - length, _delimiter.data(), length) == 0) {
+                return length;
+            }
+        }
+        return 0;
+    }
+
+    bool MultipartParser::_emit(const char* data, size_t size) {
+        if (size == 0 || _state == PREAMBLE) {
+            return true;
+        }
+        if (!_delegate.part_data(data, size)) {
+            _fail();
+            return false;
+        }
+        return true;
+    }
+
+    void MultipartParser::_handle_delimiter() {
+        if (_state == CONTENT && !_delegate.end_part()) {
+            _fail();
+            return;
+        }
+        _state = DELIMITER_LINE;
+        _line.clear();
+    }
+
+    // the line behind a delimiter and the header lines of a part, they are short and copied together
+    size_t MultipartParser::_parse_line(const char* data, size_t size) {
+        const char* new_line = static_cast<const char*>(std::memchr(data, '\n', size));
+        size_t used = new_line == NULL ? size : new_line + 1 - data;
+        if (_line.size() + used > static_cast<size_t>(Constants::MAX_LINE_LENGTH)) {
+            _fail();
+            return used;
+        }
+        _line.append(data, used);
+        if (_state == DELIMITER_LINE && _line.size() >= 2 && _line.compare(0, 2, "--") == 0) { // the closing delimiter, its CRLF is optional
+            _state = FINISHED;
+            return used;
+        }
+        if (new_line == NULL) {
+            return used;
+        }
+        _line.erase(_line.size() - 1);
+        if (!_line.empty() && _line[_line.size() - 1] == '\r') {
+            _line.erase(_line.size() - 1);
+        }
+        if (_state == DELIMITER_LINE) {
+            _handle_delimiter_line();
+        }
+        else {
+            _handle_header_line();
+        }
+        _line.clear();
+        return used;
+    }
+
+    // only linear whitespace (transport padding) may follow the boundary of a delimiter
+    void MultipartParser::_handle_delimiter_line() {
+        if (_line.find_first_not_of(" \t") != std::string::npos) {
+            _fail();
+            return;
+        }
+        _part = MultipartPart();
+        _state = HEADERS;
+    }
+
+    void MultipartParser::_handle_header_line() {
+        if (_line.empty()) {
+            if (!_delegate.begin_part(_part)) {
+                _fail();
+                return;
+            }
+            _state = CONTENT;
+            return;
+        }
+        size_t colon = _line.find(':');
+        if (colon == std::string::npos || colon == 0) {
+            _fail();
+            return;
+        }
+        std::string name = _line.substr(0, colon);
+        std::string value = get_trimmed(_line, colon + 1, std::string::npos);
+        if (strcasecmp(name.c_str(), "Content-Disposition") == 0) {
+            _part.name = get_parameter(value, "name");
+            _part.filename = get_parameter(value, "filename");
+        }
+        else if (strcasecmp(name.c_str(), "Content-Type") == 0) {
+            _part.content_type = value;
+        }
+    }
+
+    void MultipartParser::_fail() {
+        _state = FAILED;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef MULTIPARTPARSER_HPP
+#define MULTIPARTPARSER_HPP
+
+#include <string>
+#include <cstddef>
+
+#include "MultipartParserDelegate.hpp"
+
+namespace HTTPRequest {
+    // A multipart body (rfc 2046 5.1) fed piece by piece, in pieces of any size. The delimiter is
+    // looked for with a Horspool skip table straight in the fed buffers; only the few bytes at the
+    // end of a piece that may be the start of a delimiter are held back, so the memory used does not
+    // depend on the size of the body or of its parts.
+    class MultipartParser {
+
+    private:
+        enum State
+        {
+            PREAMBLE,
+            DELIMITER_LINE, // the rest of the line of a delimiter: "--" closes the body, otherwise it ends with CRLF
+            HEADERS,
+            CONTENT,
+            FINISHED,
+            FAILED
+        };
+
+        MultipartParserDelegate& _delegate;
+        std::string _delimiter; // CRLF "--" boundary, the CRLF belongs to the delimiter and not to the content before it
+        size_t _skip[256];
+        State _state;
+        std::string _carry; // end of the previous piece that may be the start of the delimiter
+        std::string _line;
+        MultipartPart _part;
+
+        size_t _parse_content(const char* data, size_t size);
+        size_t _parse_line(const char* data, size_t size);
+        size_t _find_delimiter(const char* data, size_t size) const;
+        size_t _delimiter_prefix_length(const char* data, size_t size) const;
+        bool _emit(const char* data, size_t size);
+        void _handle_delimiter();
+        void _handle_delimiter_line();
+        void _handle_header_line();
+        void _fail();
+
+        MultipartParser(const MultipartParser& other);
+        MultipartParser& operator=(const MultipartParser& other);
+
+    public:
+        MultipartParser(const std::string& boundary, MultipartParserDelegate& delegate);
+        ~MultipartParser();
+
+        bool feed(const char* data, size_t size);
+        bool is_finished() const;
+        bool is_failed() const;
+    };
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef MULTIPARTPARSERDELEGATE_HPP
+#define MULTIPARTPARSERDELEGATE_HPP
+
+#include <string>
+#include <cstddef>
+
+namespace HTTPRequest {
+    // what the headers of a body part say about it, parameters are unquoted
+    struct MultipartPart {
+        std::string name;
+        std::string filename; // empty for a plain form field
+        std::string content_type;
+    };
+
+    // Gets the parts of a multipart body as the parser finds them. The content of a part comes in as
+    // many pieces as it takes, each one is only valid during the call. Returning false stops the parser.
+    class MultipartParserDelegate {
+
+    public:
+        virtual ~MultipartParserDelegate() {}
+
+        virtual bool begin_part(const MultipartPart& part) = 0;
+        virtual bool part_data(const char* data, size_t size) = 0;
+        virtual bool end_part() = 0;
+    };
+}
+
+#endif
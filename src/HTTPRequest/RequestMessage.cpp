@@ -1,9 +1,49 @@
 #include "RequestMessage.hpp"
 
+#include <cctype> // for ::toupper
+#include <strings.h> // for strncasecmp
+#include <cstring> // for strlen
+#include <cstdlib> // for mkstemp
+#include <cstdio> // for perror
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h> // for FD_CLOEXEC
+
+#include "../Constants.hpp"
+
 namespace HTTPRequest {
-    RequestMessage::RequestMessage() : _method(""), _request_uri(""), _HTTP_version(""), _payload(""){}
+    RequestMessage::RequestMessage() : _method(""), _request_uri(""), _HTTP_version(""), _header_count(0), _content_length(-1), _payload(""), _payload_fd(-1), _payload_size(0), _body_buffer_size(Constants::DEFAULT_CLIENT_BODY_BUFFER_SIZE), _multipart_boundary("") {
+        for (int id = 0; id < KNOWN_HEADER_COUNT; ++id) {
+            _known_headers[id] = -1;
+        }
+    }
 
-    RequestMessage::~RequestMessage() {}
+    RequestMessage::~RequestMessage() {
+        if (_payload_fd != -1) {
+            close(_payload_fd);
+        }
+    }
+
+    // brings the message back to its freshly constructed state, so the next request on a persistent connection can reuse it
+    void RequestMessage::reset() {
+        _method.clear();
+        _request_uri.clear();
+        uri_data = URIData();
+        _HTTP_version.clear();
+        _header_count = 0;
+        for (int id = 0; id < KNOWN_HEADER_COUNT; ++id) {
+            _known_headers[id] = -1;
+        }
+        _content_length = -1;
+        _payload.clear();
+        _multipart_boundary.clear();
+        if (_payload_fd != -1) {
+            close(_payload_fd);
+            _payload_fd = -1;
+        }
+        _payload_size = 0;
+        _body_buffer_size = Constants::DEFAULT_CLIENT_BODY_BUFFER_SIZE;
+    }
 
     const std::string& RequestMessage::get_method() const {
         return _method;
@@ -27,42 +67,237 @@ namespace HTTPRequest {
         _HTTP_version = version;
     }
 
-    const std::string& RequestMessage::get_header_value(const std::string& header_name) const {
-        return (*_request_headers.find(header_name)).second;
+    size_t RequestMessage::get_header_count() const {
+        return _header_count;
+    }
+
+    const HeaderField& RequestMessage::get_header_field(size_t index) const {
+        return _header_fields[index];
+    }
+
+    bool RequestMessage::has_header_field(HeaderId id) const {
+        return _known_headers[id] != -1;
+    }
+
+    const std::string& RequestMessage::get_header_value(HeaderId id) const {
+        static const std::string empty;
+        return _known_headers[id] == -1 ? empty : _header_fields[_known_headers[id]].value;
+    }
+
+    // for the fields without an id, a walk over the few fields of the request
+    bool RequestMessage::has_header_field(const std::string& header_name) const {
+        return const_cast<RequestMessage*>(this)->_find_header_field(header_name) != NULL;
     }
 
-    bool RequestMessage::has_header_field(const std::string& header_name) {
-        return _request_headers.find(header_name) != _request_headers.end();
+    const std::string& RequestMessage::get_header_value(const std::string& header_name) const {
+        static const std::string empty;
+        const HeaderField* header_field = const_cast<RequestMessage*>(this)->_find_header_field(header_name);
+        return header_field == NULL ? empty : header_field->value;
     }
 
-    const std::map<std::string, std::string>& RequestMessage::get_headers() const {
-        return _request_headers;
+    HeaderField* RequestMessage::_find_header_field(const std::string& header_name) {
+        for (size_t i = 0; i < _header_count; ++i) {
+            if (_header_fields[i].name == header_name) {
+                return &_header_fields[i];
+            }
+        }
+        return NULL;
     }
 
-    void RequestMessage::set_header_field(std::pair<std::string, std::string>& header_field) {
-        std::map<std::string, std::string>::iterator header_name_position = _request_headers.find(header_field.first);
-        if ( header_name_position == _request_headers.end()) {
-            _request_headers.insert(header_field);
+    // the id is resolved here once. The field is written into the next slot of the table, whose strings
+    // a previous request on the connection may have left behind, and only counted if it was not sent before.
+    void RequestMessage::add_header_field(const Utility::StringView& name, const Utility::StringView& value) {
+        if (_header_count == _header_fields.size()) {
+            _header_fields.push_back(HeaderField());
+        }
+        HeaderField& header_field = _header_fields[_header_count];
+        header_field.id = resolve_header_id(name);
+        HeaderField* previous = NULL;
+        if (header_field.id != HEADER_OTHER) {
+            header_field.name.assign(header_key(header_field.id));
+            if (_known_headers[header_field.id] != -1) {
+                previous = &_header_fields[_known_headers[header_field.id]];
+            }
         }
         else {
-            header_name_position->second.append(", ");
-            header_name_position->second.append(header_field.second);
+            header_field.name.assign(name.data(), name.size());
+            for (std::string::iterator it = header_field.name.begin(); it != header_field.name.end(); ++it) {
+                *it = *it == '-' ? '_' : static_cast<char>(::toupper(static_cast<unsigned char>(*it)));
+            }
+            previous = _find_header_field(header_field.name);
+        }
+        if (previous != NULL) {
+            previous->value.append(", ");
+            previous->value.append(value.data(), value.size());
+            return;
+        }
+        header_field.value.assign(value.data(), value.size());
+        if (header_field.id != HEADER_OTHER) {
+            _known_headers[header_field.id] = static_cast<int>(_header_count);
         }
+        _header_count++;
+    }
+
+    void RequestMessage::update_header_field(HeaderId id, const std::string& new_value) {
+        if (_known_headers[id] != -1) {
+            _header_fields[_known_headers[id]].value = new_value;
+        }
+    }
+
+    ssize_t RequestMessage::get_content_length() const {
+        return _content_length;
+    }
+
+    void RequestMessage::set_content_length(size_t content_length) {
+        _content_length = content_length;
+    }
+
+    // the Host field without the port
+    Utility::StringView RequestMessage::get_host_name() const {
+        const std::string& host = get_header_value(HEADER_HOST);
+        return Utility::StringView(host.data(), host.find(':') == std::string::npos ? host.size() : host.find(':'));
     }
 
-    void RequestMessage::update_header_field(const std::string& header_name, const std::string& new_value) {
-        std::map<std::string, std::string>::iterator header_name_position = _request_headers.find(header_name);
-        if ( header_name_position != _request_headers.end()) {
-            header_name_position->second = new_value;
+    // options of the Connection field are case-insensitive and separated by commas
+    bool RequestMessage::has_connection_option(const char* option) const {
+        Utility::StringView options(get_header_value(HEADER_CONNECTION).data(), get_header_value(HEADER_CONNECTION).size());
+        size_t option_size = strlen(option);
+        size_t start = 0;
+        while (start <= options.size()) {
+            size_t comma = options.find(',', start);
+            if (comma == Utility::StringView::npos) {
+                comma = options.size();
+            }
+            Utility::StringView candidate = options.substr(start, comma - start).trim();
+            if (candidate.size() == option_size && strncasecmp(candidate.data(), option, option_size) == 0) {
+                return true;
+            }
+            start = comma + 1;
         }
+        return false;
     }
 
+    // only the body that stayed in memory, a bigger one is in get_payload_fd()
     const std::string& RequestMessage::get_message_body() const {
         return _payload;
     }
 
-    void RequestMessage::set_payload(std::string& body) {
-        _payload.append(body);
+    size_t RequestMessage::get_payload_size() const {
+        return _payload_size;
+    }
+
+    int RequestMessage::get_payload_fd() const {
+        return _payload_fd;
+    }
+
+    void RequestMessage::set_body_buffer_size(size_t body_buffer_size) {
+        _body_buffer_size = body_buffer_size;
+    }
+
+    // empty unless the body is multipart, without the leading "--"
+    const std::string& RequestMessage::get_multipart_boundary() const {
+        return _multipart_boundary;
+    }
+
+    void RequestMessage::set_multipart_boundary(const std::string& boundary) {
+        _multipart_boundary = boundary;
+    }
+
+    namespace {
+        bool write_all(int fd, const char *data, size_t size) {
+            while (size > 0) {
+                ssize_t written = write(fd, data, size);
+                if (written == -1 && errno == EINTR) {
+                    continue;
+                }
+                if (written <= 0) {
+                    std::perror("write error");
+                    return false;
+                }
+                data += written;
+                size -= written;
+            }
+            return true;
+        }
+    }
+
+    // false if the body had to go to a temporary file that could not be written
+    bool RequestMessage::append_payload(const char *data, size_t size) {
+        if (_payload_fd == -1 && _payload_size + size > _body_buffer_size && !_spill_payload()) {
+            return false;
+        }
+        _payload_size += size;
+        if (_payload_fd == -1) {
+            _payload.append(data, size);
+            return true;
+        }
+        return write_all(_payload_fd, data, size);
+    }
+
+    // moves a body that is still in memory to a temporary file, whatever its size
+    bool RequestMessage::store_payload_in_file() {
+        return _payload_fd != -1 || _spill_payload();
+    }
+
+    // the file is unlinked right away, nothing is left behind once its fd is closed
+    bool RequestMessage::_spill_payload() {
+        std::string path(Constants::CLIENT_BODY_TEMP_FILE);
+        int fd = mkstemp(&path[0]);
+        if (fd == -1) {
+            std::perror("mkstemp error");
+            return false;
+        }
+        unlink(path.c_str());
+        fcntl(fd, F_SETFD, FD_CLOEXEC); // a CGI gets it as its stdin through dup2, no other child should
+        if (!write_all(fd, _payload.data(), _payload.size())) {
+            close(fd);
+            return false;
+        }
+        _payload_fd = fd;
+        std::string().swap(_payload); // gives the memory back, clear() would keep it
+        return true;
+    }
+
+    // up to size bytes of the body from offset on, wherever it is; -1 if the temporary file could not be read
+    ssize_t RequestMessage::read_payload(size_t offset, char *buffer, size_t size) const {
+        if (offset >= _payload_size) {
+            return 0;
+        }
+        if (size > _payload_size - offset) {
+            size = _payload_size - offset;
+        }
+        if (_payload_fd == -1) {
+            _payload.copy(buffer, size, offset);
+            return size;
+        }
+        ssize_t bytes_read;
+        do {
+            bytes_read = pread(_payload_fd, buffer, size, offset);
+        } while (bytes_read == -1 && errno == EINTR);
+        if (bytes_read <= 0) {
+            std::perror("pread error");
+            return -1;
+        }
+        return bytes_read;
+    }
+
+    // the body wherever it is, from a temporary file in pieces of a read at most
+    bool RequestMessage::write_payload(std::ostream& out) const {
+        if (_payload_fd == -1) {
+            out << _payload;
+            return out.good();
+        }
+        char buffer[Constants::BODY_READ_SIZE];
+        size_t offset = 0;
+        while (offset < _payload_size) {
+            ssize_t bytes_read = read_payload(offset, buffer, sizeof(buffer));
+            if (bytes_read == -1) {
+                return false;
+            }
+            out.write(buffer, bytes_read);
+            offset += bytes_read;
+        }
+        return out.good();
     }
 
     void RequestMessage::set_uri(URIData &uri)
@@ -1,11 +1,21 @@
 #ifndef RequestMessage_HPP
 #define RequestMessage_HPP
 #include <string>
-#include <map>
+#include <vector>
+#include <ostream>
+#include <sys/types.h> // for ssize_t
 
+#include "HeaderFields.hpp"
 #include "URI/URIData.hpp"
+#include "../Utility/StringView.hpp"
 
 namespace HTTPRequest {
+    struct HeaderField {
+        HeaderId id;
+        std::string name; // uppercased with '-' as '_': CONTENT_TYPE
+        std::string value; // the values of repeated fields joined by ", "
+    };
+
     class RequestMessage {
 
     private:
@@ -13,8 +23,18 @@ namespace HTTPRequest {
         std::string _request_uri;
         URIData uri_data;
         std::string _HTTP_version;
-        std::map<std::string, std::string> _request_headers;
-        std::string _payload;
+        std::vector<HeaderField> _header_fields; // the first _header_count belong to this request, the rest keep their buffers for the next one
+        size_t _header_count;
+        int _known_headers[KNOWN_HEADER_COUNT]; // the position of every field with an id in _header_fields, -1 if it was not sent
+        ssize_t _content_length; // -1 without a valid Content-Length
+        std::string _payload; // the body, as long as it fits into _body_buffer_size
+        int _payload_fd; // the unlinked temporary file holding a bigger body, -1 while it is in _payload
+        size_t _payload_size;
+        size_t _body_buffer_size;
+        std::string _multipart_boundary;
+
+        HeaderField* _find_header_field(const std::string& header_name);
+        bool _spill_payload();
 
     public:
         RequestMessage();
@@ -22,6 +42,8 @@ namespace HTTPRequest {
         ~RequestMessage();
         const RequestMessage& operator=(const RequestMessage& other);
 
+        void reset();
+
         const std::string& get_method() const;
         void set_method(std::string& method);
         void set_uri(URIData &uri);
@@ -30,13 +52,28 @@ namespace HTTPRequest {
         void set_request_uri(std::string& request_uri);
         const std::string& get_HTTP_version() const;
         void set_HTTP_version(std::string& version);
-        const std::map<std::string, std::string>& get_headers() const;
+        size_t get_header_count() const;
+        const HeaderField& get_header_field(size_t index) const;
+        bool has_header_field(HeaderId id) const;
+        const std::string& get_header_value(HeaderId id) const;
+        bool has_header_field(const std::string& header_name) const;
         const std::string& get_header_value(const std::string& header_name) const;
-        bool has_header_field(const std::string& header_name);
-        void set_header_field(std::pair<std::string, std::string>& header_field);
-        void update_header_field(const std::string& header_name, const std::string& new_value);
+        void add_header_field(const Utility::StringView& name, const Utility::StringView& value);
+        void update_header_field(HeaderId id, const std::string& new_value);
+        ssize_t get_content_length() const;
+        void set_content_length(size_t content_length);
+        Utility::StringView get_host_name() const;
+        bool has_connection_option(const char* option) const;
         const std::string& get_message_body() const;
-        void set_payload(std::string& body);
+        size_t get_payload_size() const;
+        int get_payload_fd() const;
+        void set_body_buffer_size(size_t body_buffer_size);
+        const std::string& get_multipart_boundary() const;
+        void set_multipart_boundary(const std::string& boundary);
+        bool append_payload(const char *data, size_t size);
+        bool store_payload_in_file();
+        ssize_t read_payload(size_t offset, char *buffer, size_t size) const;
+        bool write_payload(std::ostream& out) const;
     };
 }
 #endif
@@ -1,13 +1,14 @@
 #include "RequestParser.hpp"
 #include <algorithm> // for std::distance
 #include <utility> // for std::make_pair
-#include <cstdlib> // for atoi
-#include <cctype> // for ::toupper
+#include <cstdlib> // for strtol
+#include <cerrno>
 #include  <climits> // for INT_MAX
 
 #include "HTTPRequestMethods.hpp"
 #include "../HTTP/Exceptions/RequestException.hpp"
 #include "../Utility/Utility.hpp"
+#include "../Utility/CharScan.hpp"
 #include "../Constants.hpp"
 
 
@@ -18,62 +19,59 @@ namespace HTTPRequest {
         {HEADER, &RequestParser::_parse_header},
         {PAYLOAD, &RequestParser::_parse_payload},
         {CHUNKED_PAYLOAD, &RequestParser::_decode_chunked},
-        {MULTIPART_PAYLOAD, &RequestParser::_parse_multipart_payload},
         {TRAILER, &RequestParser::_parse_trailer_header_fields},
         {FINISHED, NULL}
     };
 
     RequestParser::RequestParser(HTTPRequest::RequestMessage* http_request, HTTPResponse::ResponseMessage* http_response)
-        : _current_parsing_state(REQUEST_LINE)
+        : _delegate(NULL)
+        , _max_body_size(Constants::DEFAULT_MAX_SIZE_BODY)
+        , _current_parsing_state(REQUEST_LINE)
         , _payload_bytes_left_to_parse(0)
-        , _boundary("")
         , _http_request_message(http_request)
         , _http_response_message(http_response){}
 
     RequestParser::~RequestParser(){}
 
-    void RequestParser::parse_HTTP_request(char* buffer, size_t bytes_read) {
+    void RequestParser::set_delegate(RequestParserDelegate* delegate) {
+        _delegate = delegate;
+    }
+
+    // returns the number of bytes that belong to the current request, the rest of the buffer (if any) is the start of a pipelined request
+    size_t RequestParser::parse_HTTP_request(char* buffer, size_t bytes_read) {
         size_t bytes_accumulated = 0;
-        while (bytes_accumulated != bytes_read) {
-            bool can_be_parsed = false;
-            std::string line;
-            if (_current_parsing_state == CHUNKED_PAYLOAD && _chunk_size > 0) {
-                line = _request_reader.read_chunk(_chunk_size, buffer, bytes_read, &bytes_accumulated, &can_be_parsed);
+        while (bytes_accumulated != bytes_read && _current_parsing_state != FINISHED) {
+            Utility::StringView part; // points into buffer, or into the reader for a line that came in pieces
+            if (_current_parsing_state == PAYLOAD) {
+                part = _request_reader.read_bytes(buffer, bytes_read, &bytes_accumulated, _payload_bytes_left_to_parse);
+                _payload_bytes_left_to_parse -= part.size();
             }
-            else if (_current_parsing_state == PAYLOAD) {
-                line = _request_reader.read_payload(buffer, bytes_read, &bytes_accumulated, &can_be_parsed);
-                size_t line_size = line.size();
-                _payload_bytes_left_to_parse -= line_size;
-                can_be_parsed = true;
-                if (_payload_bytes_left_to_parse < 0) {
-                    _throw_request_exception(HTTPResponse::BadRequest);
-                }
+            else if (_current_parsing_state == CHUNKED_PAYLOAD && _chunk_size > 0) {
+                part = _request_reader.read_bytes(buffer, bytes_read, &bytes_accumulated, _chunk_size);
             }
-            else {
-                line = _request_reader.read_line(buffer, bytes_read, &bytes_accumulated, &can_be_parsed);
-                if (_current_parsing_state == MULTIPART_PAYLOAD) {
-                    _payload_bytes_left_to_parse -= line.size();
-                }
-                if (can_be_parsed) {
-                    line.erase(line.size() - 2, 2);
-                }
+            else if (!_read_line(buffer, bytes_read, &bytes_accumulated, part)) {
+                return bytes_accumulated;
             }
-            if (can_be_parsed == true) {
-                _handle_request_message_part(line);
-                if (_current_parsing_state == PAYLOAD && _boundary == "" && _http_request_message->get_message_body().size() == 0) { // validating headers only once, right after we've finished parsing them
-                    _validate_headers();
-                }
-            }
-            else {
-                return;
+            _handle_request_message_part(part);
+            if (_payload_bytes_left_to_parse == 0 && _current_parsing_state == PAYLOAD) { // no (more) payload to wait for
+                _current_parsing_state = FINISHED;
             }
         }
-        if (_payload_bytes_left_to_parse == 0 && _current_parsing_state == PAYLOAD) {
-            _current_parsing_state = FINISHED;
+        return bytes_accumulated;
+    }
+
+    // the reader refuses a line that is too long, the request ends there like for any other error
+    bool RequestParser::_read_line(const char* buffer, size_t bytes_read, size_t* bytes_accumulated, Utility::StringView& line) {
+        try {
+            return _request_reader.read_line(buffer, bytes_read, bytes_accumulated, line);
+        }
+        catch (const Exception::RequestException& e) {
+            _throw_request_exception(e.get_error_status_code());
         }
+        return false;
     }
 
-    void RequestParser::_handle_request_message_part(std::string& line) {
+    void RequestParser::_handle_request_message_part(const Utility::StringView& line) {
         Dispatch *message = _dispatch_table;
         for (size_t i = 0; message[i].parsing_state != FINISHED; ++i) {
             if (message[i].parsing_state == _current_parsing_state) {
@@ -87,25 +85,45 @@ namespace HTTPRequest {
         return _current_parsing_state == FINISHED;
     }
 
+    // prepares the parser for the next request arriving on the same (persistent) connection
+    void RequestParser::reset() {
+        _request_reader.reset();
+        _current_parsing_state = REQUEST_LINE;
+        _payload_bytes_left_to_parse = 0;
+        _chunk_size = 0;
+        _chunk_data_ended = false;
+        _decoded_body_length = 0;
+        _max_body_size = Constants::DEFAULT_MAX_SIZE_BODY;
+    }
+
     void RequestParser::_throw_request_exception(HTTPResponse::StatusCode error_status) {
         _current_parsing_state = FINISHED;
         throw Exception::RequestException(error_status);
     }
 
-    void RequestParser::_parse_request_line(std::string& line) {
-        if (line.empty()) {
+    void RequestParser::_parse_request_line(const Utility::StringView& line) {
+        // exactly three parts, split by single spaces: a token, a target and a version without control characters
+        size_t method_end = Utility::find_non_token(line.data(), line.size());
+        if (method_end == 0 || method_end == line.size() || line[method_end] != ' ') {
+            _throw_request_exception(HTTPResponse::BadRequest);
+        }
+        Utility::StringView rest = line.substr(method_end + 1);
+        size_t target_end = Utility::find_control_or(rest.data(), rest.size(), ' ');
+        if (target_end == 0 || target_end == rest.size() || rest[target_end] != ' ') {
             _throw_request_exception(HTTPResponse::BadRequest);
         }
-        std::vector<std::string> segments = Utility::_split_line(line, ' ');
-        if (segments.size() != 3) {
+        Utility::StringView version_part = rest.substr(target_end + 1);
+        if (version_part.empty() || Utility::find_control_or(version_part.data(), version_part.size(), ' ') != version_part.size()) {
             _throw_request_exception(HTTPResponse::BadRequest);
         }
-        if (_is_method_supported(segments[0])) {
-            _http_request_message->set_method(segments[0]);
+        std::string method = line.substr(0, method_end).str();
+        if (_is_method_supported(method)) {
+            _http_request_message->set_method(method);
         }
-        _http_request_message->set_request_uri(segments[1]);
+        std::string request_uri = rest.substr(0, target_end).str();
+        _http_request_message->set_request_uri(request_uri);
 
-        URIParser uri_parser(segments[1]);
+        URIParser uri_parser(request_uri);
         URIData uri_data;
         try{
             uri_parser.parse(uri_data);
@@ -115,7 +133,8 @@ namespace HTTPRequest {
         }
         _http_request_message->set_uri(uri_data);
 
-        _http_request_message->set_HTTP_version(segments[2]);
+        std::string version = version_part.str();
+        _http_request_message->set_HTTP_version(version);
         _current_parsing_state = HEADER;
     }
 
@@ -140,57 +159,76 @@ namespace HTTPRequest {
         return longest_size;
     }
 
-    void RequestParser::_parse_header(std::string& line) {
-        if (line == "\r\n" || line == "") {
+    // only the name and the value are copied out of the line, add_header_field resolves the id of the name and stores it normalized
+    void RequestParser::_parse_header(const Utility::StringView& line) {
+        if (line.empty()) {
             _current_parsing_state = PAYLOAD;
+            _validate_headers();
             return;
         }
-        std::vector<std::string> segments = Utility::_split_line(line, ':');
-        if (segments.size() < 2) {
+        if (_http_request_message->get_header_count() >= static_cast<size_t>(Constants::MAX_HEADER_FIELDS)) {
+            _throw_request_exception(HTTPResponse::RequestHeaderFieldsTooLarge);
+        }
+        Utility::StringView name;
+        Utility::StringView value;
+        _split_header_field(line, name, value);
+        _http_request_message->add_header_field(name, value);
+    }
+
+    // the name is a token directly followed by the colon (no whitespace in between, rfc 9112 5.1), the value holds no control characters
+    void RequestParser::_split_header_field(const Utility::StringView& line, Utility::StringView& name, Utility::StringView& value) {
+        size_t colon = Utility::find_non_token(line.data(), line.size());
+        if (colon == 0 || colon == line.size() || line[colon] != ':') {
             _throw_request_exception(HTTPResponse::BadRequest);
         }
-        if (Utility::contains_whitespace(segments[0])) {
+        name = line.substr(0, colon);
+        value = line.substr(colon + 1).trim();
+        if (Utility::find_control_or(value.data(), value.size(), '\0') != value.size()) {
             _throw_request_exception(HTTPResponse::BadRequest);
         }
-        std::string uppercased_header_name = _convert_header_name_touppercase(segments[0]);
-        std::pair<std::string, std::string> header_field(uppercased_header_name, Utility::_trim(segments[1]));
-        _http_request_message->set_header_field(header_field);
-    }
-
-    std::string RequestParser::_convert_header_name_touppercase(std::string& header_name) {
-        std::transform(header_name.begin(), header_name.end(),header_name.begin(), ::toupper);
-        std::replace_if (header_name.begin(), header_name.end(), Utility::is_hyphen, '_');
-        return header_name;
     }
 
     void RequestParser::_validate_headers() {
+        _apply_body_limits();
         _define_payload_length_type();
         _check_multipart_content_type();
     }
+
+    // the limits of the server and location the request is for, so that a body known to be too big is refused before any of it is read
+    void RequestParser::_apply_body_limits() {
+        if (_delegate == NULL) {
+            return;
+        }
+        BodyLimits limits = _delegate->get_body_limits();
+        _max_body_size = limits.max_size;
+        _http_request_message->set_body_buffer_size(limits.buffer_size);
+    }
+
+    void RequestParser::_append_payload(const Utility::StringView& part) {
+        if (!_http_request_message->append_payload(part.data(), part.size())) {
+            _throw_request_exception(HTTPResponse::InternalServerError);
+        }
+    }
         
     void RequestParser::_define_payload_length_type() {
-        std::map<std::string, std::string> headers_map = _http_request_message->get_headers();
-        std::map<std::string, std::string>::iterator transfer_encoding_iter = headers_map.find("TRANSFER_ENCODING");
-        if (_http_request_message->has_header_field("CONTENT_LENGTH")) {
-            if (!(_http_request_message->has_header_field("TRANSFER_ENCODING"))) {
+        if (_http_request_message->has_header_field(HEADER_CONTENT_LENGTH)) {
+            if (!(_http_request_message->has_header_field(HEADER_TRANSFER_ENCODING))) {
                 _payload_length_type = CONTENT_LENGTH;
                 _set_content_length();
             }
             else {
-                _parse_transfer_encoding(transfer_encoding_iter->second);
+                _parse_transfer_encoding(_http_request_message->get_header_value(HEADER_TRANSFER_ENCODING));
                 if (_payload_length_type == CHUNKED) {
-                    _current_parsing_state = CHUNKED_PAYLOAD;
-                    _chunk_size = -1;
-                    _decoded_body_length = 0;
-                    _decoded_body = "";
+                    _start_chunked_decoding();
                 }
             }
         }
-        else if (_http_request_message->has_header_field("TRANSFER_ENCODING")) { // if headers contain Transfer-Encoding without Content-length
-            _parse_transfer_encoding(transfer_encoding_iter->second);
+        else if (_http_request_message->has_header_field(HEADER_TRANSFER_ENCODING)) { // if headers contain Transfer-Encoding without Content-length
+            _parse_transfer_encoding(_http_request_message->get_header_value(HEADER_TRANSFER_ENCODING));
             if (_payload_length_type != CHUNKED) {
                 _throw_request_exception(HTTPResponse::LengthRequired);
             }
+            _start_chunked_decoding();
         }
         else {
             if (_http_request_message->get_method() == "POST") {
@@ -199,8 +237,15 @@ namespace HTTPRequest {
         }
     }
 
+    void RequestParser::_start_chunked_decoding() {
+        _current_parsing_state = CHUNKED_PAYLOAD;
+        _chunk_size = -1;
+        _chunk_data_ended = false;
+        _decoded_body_length = 0;
+    }
+
     void RequestParser::_set_content_length() {
-        std::string content_length_value = _http_request_message->get_headers().find("CONTENT_LENGTH")->second;
+        std::string content_length_value = _http_request_message->get_header_value(HEADER_CONTENT_LENGTH);
         if (content_length_value.find_first_of(',', 0) != std::string::npos) {
             std::vector<std::string> values = Utility::_split_line(content_length_value, ',');
             std::string first_value = Utility::_trim(values[0]);
@@ -210,48 +255,57 @@ namespace HTTPRequest {
                 }
             }
             content_length_value = first_value;
-            _http_request_message->update_header_field("CONTENT_LENGTH", content_length_value);
+            _http_request_message->update_header_field(HEADER_CONTENT_LENGTH, content_length_value);
         }
         for (std::string::iterator it = content_length_value.begin(); it != content_length_value.end(); ++it) {
             if (!isdigit(*it)) {
                 _throw_request_exception(HTTPResponse::BadRequest); // should throw for negative values as well
             }
         }
-        _payload_bytes_left_to_parse = std::atoi(content_length_value.c_str());
-        if (_payload_bytes_left_to_parse > Constants::PAYLOAD_MAX_LENGTH) {
+        if (content_length_value.empty()) {
+            _throw_request_exception(HTTPResponse::BadRequest);
+        }
+        errno = 0;
+        long content_length = std::strtol(content_length_value.c_str(), NULL, 10);
+        if (errno == ERANGE || content_length > _max_body_size) {
             _throw_request_exception(HTTPResponse::ContentTooLarge);
         }
+        _payload_bytes_left_to_parse = content_length;
+        _http_request_message->set_content_length(_payload_bytes_left_to_parse);
     }
 
     void RequestParser::_check_multipart_content_type() {
-        if (!(_http_request_message->has_header_field("CONTENT_TYPE"))) {
+        if (!(_http_request_message->has_header_field(HEADER_CONTENT_TYPE))) {
             return;
         }
-        std::string content_type_value = _http_request_message->get_header_value("CONTENT_TYPE");
-        if (Utility::is_found(content_type_value, "multipart")) {
+        std::string content_type_value = _http_request_message->get_header_value(HEADER_CONTENT_TYPE);
+        if (Utility::is_found(content_type_value, "multipart")) { // the body is taken as it is, its parts are split up once it is used
             _set_multipart_boundary(content_type_value);
-            _current_parsing_state = MULTIPART_PAYLOAD;
         }
     }
-    
-    void RequestParser::_set_multipart_boundary(std::string& content_type_value) {
-        std::vector<std::string> parts = Utility::_split_line(content_type_value, ' ');
-        std::vector<std::string>::iterator iter = parts.begin();
-        for (; iter != parts.end(); iter++) {
-            std::string boundary_marker = "boundary=";
-            size_t boundary_marker_size = boundary_marker.size();
-            if (Utility::is_found(*iter, boundary_marker)) {
-                size_t boundary_parameter_value_size = (*iter).size() - boundary_marker_size;
-                if (boundary_parameter_value_size > 70) { // boundary parameter cannot exceed 70 characters
-                    _throw_request_exception(HTTPResponse::BadRequest);
-                }
-                _boundary = "--" + (*iter).substr(boundary_marker_size, boundary_parameter_value_size);
-            }
+
+    // multipart/form-data; boundary=value or boundary="value", without it the parts could not be told apart
+    void RequestParser::_set_multipart_boundary(const std::string& content_type_value) {
+        const std::string boundary_marker = "boundary=";
+        size_t start = content_type_value.find(boundary_marker);
+        if (start == std::string::npos) {
+            _throw_request_exception(HTTPResponse::BadRequest);
         }
+        start += boundary_marker.size();
+        size_t end = content_type_value.find(';', start);
+        Utility::StringView boundary(content_type_value.data() + start, (end == std::string::npos ? content_type_value.size() : end) - start);
+        boundary = boundary.trim();
+        if (boundary.size() >= 2 && boundary[0] == '"' && boundary[boundary.size() - 1] == '"') {
+            boundary = boundary.substr(1, boundary.size() - 2);
+        }
+        if (boundary.empty() || boundary.size() > 70) { // boundary parameter cannot exceed 70 characters
+            _throw_request_exception(HTTPResponse::BadRequest);
+        }
+        _http_request_message->set_multipart_boundary(boundary.str());
     }
 
     // need to find the position of the 'chunked' in transfer-Encodeing as rfc demands to throw the 400 Error if 'chunked'is not the final encoding
-    void RequestParser::_parse_transfer_encoding(std::string& coding_names_list) {
+    void RequestParser::_parse_transfer_encoding(const std::string& coding_names_list) {
         std::vector<std::string> encodings = Utility::_split_line(coding_names_list, ','); //splitting the header value as there might be multiple encodings
         ssize_t encodings_num = encodings.size();
         ssize_t chunked_position = _find_chunked_encoding_position(encodings, encodings_num);
@@ -277,46 +331,39 @@ namespace HTTPRequest {
         return -1;
     }
 
-    void RequestParser::_parse_multipart_payload(std::string& line) {
-        if (line == _boundary) {
-            return;
-        }
-        if (line == _boundary + "--") {
-            _current_parsing_state = FINISHED;
-            return;
-        }
-        _parse_header(line);
-    }
-
-    void RequestParser::_parse_payload(std::string& line) {
-        if (line != _boundary + "--\r\n") {
-            _http_request_message->set_payload(line);
-        }
+    // the payload arrives in the pieces the reads brought, each one is appended as it is
+    void RequestParser::_parse_payload(const Utility::StringView& line) {
+        _append_payload(line);
         if (_payload_bytes_left_to_parse == 0 &&  _current_parsing_state != TRAILER) {
             _current_parsing_state = FINISHED;
         }
     }
 
-
-    void RequestParser::_decode_chunked(std::string& line) {
-        if (_chunk_size >= 0 ) {
-            _decoded_body.append(line); // in this case we're dealing with the payload data
-            size_t line_size = line.size();
-            _chunk_size -= line_size;
-            _decoded_body_length += line_size;
+    // the data of a chunk goes into the payload as it arrives, it is not gathered first
+    void RequestParser::_decode_chunked(const Utility::StringView& line) {
+        if (_chunk_size > 0) {
+            _append_payload(line);
+            _chunk_size -= line.size();
+            _decoded_body_length += line.size();
             if (_chunk_size == 0) {
                 _chunk_size = -1; // after handling the data we have to make sure we set the new chunk_size in the next iteration
+                _chunk_data_ended = true;
             }
         }
+        else if (_chunk_data_ended) { // the CRLF behind the data of the chunk
+            if (!line.empty()) {
+                _throw_request_exception(HTTPResponse::BadRequest);
+            }
+            _chunk_data_ended = false;
+        }
         else { // the chunk_size is reset to -1 before the chunk_length will be defined
             _set_chunk_size(line);
             if (_is_last_chunk()) {
-                if (_http_request_message->has_header_field("TRAILER")) {
+                if (_http_request_message->has_header_field(HEADER_TRAILER)) {
                     _check_disallowed_trailer_header_fields();
-                    _current_parsing_state = TRAILER;
                 }
+                _current_parsing_state = TRAILER; // the (possibly empty) trailer section and the final CRLF are still part of this request
                 _assign_decoded_body_length_to_content_length();
-                _parse_payload(_decoded_body);
                 _remove_chunked_from_transfer_encoding(); // this is what rfc demands
             }
         }
@@ -327,46 +374,56 @@ namespace HTTPRequest {
     }
 
     void RequestParser::_assign_decoded_body_length_to_content_length() {
-        std::string content_length_header_name = "CONTENT_LENGTH";
         const std::string content_length_value = Utility::to_string(_decoded_body_length);
-        if (_http_request_message->has_header_field(content_length_header_name)) {
-            _http_request_message->update_header_field(content_length_header_name, content_length_value);
+        if (_http_request_message->has_header_field(HEADER_CONTENT_LENGTH)) {
+            _http_request_message->update_header_field(HEADER_CONTENT_LENGTH, content_length_value);
         }
         else {
-            std::pair<std::string, std::string> header_field(content_length_header_name, content_length_value);
-            _http_request_message->set_header_field(header_field);
+            _http_request_message->add_header_field(Utility::StringView("Content-Length", 14), Utility::StringView(content_length_value.data(), content_length_value.size()));
         }
+        _http_request_message->set_content_length(_decoded_body_length);
     }
 
-    void RequestParser::_set_chunk_size(std::string& line) {
-        std::string extracted_number = Utility::get_number_in_string(line);
-        if (extracted_number == "") {
+    // the hex digits at the start of the line, chunk extensions after them are ignored
+    void RequestParser::_set_chunk_size(const Utility::StringView& line) {
+        ssize_t chunk_size = 0;
+        size_t digits = 0;
+        for (; digits < line.size(); ++digits) {
+            char character = line[digits];
+            int value;
+            if (character >= '0' && character <= '9')
+                value = character - '0';
+            else if (character >= 'a' && character <= 'f')
+                value = character - 'a' + 10;
+            else if (character >= 'A' && character <= 'F')
+                value = character - 'A' + 10;
+            else
+                break;
+            chunk_size = chunk_size * 16 + value;
+            if (chunk_size > _max_body_size) { // checked per digit, so that it cannot overflow
+                _throw_request_exception(HTTPResponse::ContentTooLarge);
+            }
+        }
+        if (digits == 0) {
             _throw_request_exception(HTTPResponse::BadRequest);
         }
-        else {
-            std::stringstream ss; // converting hex to the ssize_t
-            ss << std::hex << extracted_number;
-            ss >> _chunk_size;
-            if (_chunk_size > Constants::PAYLOAD_MAX_LENGTH) {
-                _throw_request_exception(HTTPResponse::BadRequest);
-            }
+        if (static_cast<long>(_decoded_body_length) + chunk_size > _max_body_size) {
+            _throw_request_exception(HTTPResponse::ContentTooLarge);
         }
+        _chunk_size = chunk_size;
     }
 
     void RequestParser::_remove_chunked_from_transfer_encoding() {
-        const std::map<std::string, std::string>& headers = _http_request_message->get_headers();
-        std::string name = "TRANSFER_ENCODING";
-        std::map<std::string, std::string>::const_iterator transfer_encoding_iter = headers.find(name);
-        std::string value = transfer_encoding_iter->second;
+        std::string value = _http_request_message->get_header_value(HEADER_TRANSFER_ENCODING);
         // chunked must always be the last parameter of transfer encoding. We're erasing the last part of the string which must be the length of "chunked"
         const std::string part_to_erase = "chunked";
         value.erase(value.end() - part_to_erase.size(), value.end());
-        _http_request_message->update_header_field(name, value);
+        _http_request_message->update_header_field(HEADER_TRANSFER_ENCODING, value);
     }
 
 // this is the list of the header fields that are not allowed to be placed in Trailer headers
     void RequestParser::_check_disallowed_trailer_header_fields() {
-       const std::string& trailer_value = _http_request_message->get_header_value("TRAILER");
+       const std::string& trailer_value = _http_request_message->get_header_value(HEADER_TRAILER);
        if (Utility::is_found(trailer_value, "Transfer-Encoding")
             || Utility::is_found(trailer_value, "Content-Length")
             || Utility::is_found(trailer_value, "Host")
@@ -382,20 +439,19 @@ namespace HTTPRequest {
         }
     }
 
-    void RequestParser::_parse_trailer_header_fields(std::string &line) {
-        if (line == "\r\n" || line == "") {
+    void RequestParser::_parse_trailer_header_fields(const Utility::StringView& line) {
+        if (line.empty()) {
             _current_parsing_state = FINISHED;
             return;
         }
-        std::vector<std::string> segments = Utility::_split_line_in_two(line, ':');
-        if (Utility::contains_whitespace(segments[0])) {
-            _throw_request_exception(HTTPResponse::BadRequest);
+        Utility::StringView name;
+        Utility::StringView value;
+        _split_header_field(line, name, value);
+        if (!_http_request_message->has_header_field(HEADER_TRAILER)) { // only announced trailer fields are kept
+            return;
         }
-        const std::string& trailer_value = _http_request_message->get_header_value("TRAILER");
-        if (Utility::is_found(trailer_value, segments[0])) {
-            std::string uppercased_header_name = _convert_header_name_touppercase(segments[0]);
-            std::pair<std::string, std::string> header_field(uppercased_header_name, Utility::_trim(segments[1]));
-            _http_request_message->set_header_field(header_field);
+        if (Utility::is_found(_http_request_message->get_header_value(HEADER_TRAILER), name.str())) {
+            _http_request_message->add_header_field(name, value);
         }
     }
 }
@@ -6,6 +6,7 @@
 #include <sys/types.h>// for ssize_t
 
 #include "RequestReader.hpp"
+#include "RequestParserDelegate.hpp"
 #include "RequestMessage.hpp"
 #include "../HTTPResponse/ResponseMessage.hpp"
 #include "../HTTPResponse/StatusCodes.hpp"
@@ -22,7 +23,6 @@ namespace HTTPRequest {
             HEADER,
             PAYLOAD,
             CHUNKED_PAYLOAD,
-            MULTIPART_PAYLOAD,
             TRAILER,
             FINISHED
         };
@@ -35,31 +35,35 @@ namespace HTTPRequest {
         };
 
         RequestReader _request_reader;
+        RequestParserDelegate* _delegate;
+        long _max_body_size;
         State _current_parsing_state;
         MessageBodyLength _payload_length_type;
         ssize_t _payload_bytes_left_to_parse;
 
         ssize_t _chunk_size;
+        bool _chunk_data_ended; // the CRLF behind the data of a chunk is awaited
 		size_t _decoded_body_length;
-		std::string _decoded_body;
 
-		std::string _boundary;
-
-        void _handle_request_message_part(std::string& line);
-        void _parse_request_line(std::string& line);
-        void _parse_header(std::string& line);
+        bool _read_line(const char* buffer, size_t bytes_read, size_t* bytes_accumulated, Utility::StringView& line);
+        void _handle_request_message_part(const Utility::StringView& line);
+        void _parse_request_line(const Utility::StringView& line);
+        void _parse_header(const Utility::StringView& line);
+        void _split_header_field(const Utility::StringView& line, Utility::StringView& name, Utility::StringView& value);
         void _validate_headers();
+        void _apply_body_limits();
+        void _append_payload(const Utility::StringView& part);
         void _define_payload_length_type();
+        void _start_chunked_decoding();
         void _check_multipart_content_type();
-        void _set_multipart_boundary(std::string& content_type_value);
-        void _parse_transfer_encoding(std::string &coding_names_list);
+        void _set_multipart_boundary(const std::string& content_type_value);
+        void _parse_transfer_encoding(const std::string &coding_names_list);
         void _set_content_length();
         ssize_t _find_chunked_encoding_position(std::vector<std::string> &encodings, size_t encodings_num);
-        void _parse_payload(std::string &line);
-        void _parse_multipart_payload(std::string &line);
-        void _parse_trailer_header_fields(std::string &line);
-        void _decode_chunked(std::string& line);
-        void _set_chunk_size(std::string& line);
+        void _parse_payload(const Utility::StringView& line);
+        void _parse_trailer_header_fields(const Utility::StringView& line);
+        void _decode_chunked(const Utility::StringView& line);
+        void _set_chunk_size(const Utility::StringView& line);
         void _assign_decoded_body_length_to_content_length();
 		bool _is_last_chunk();
 		void _remove_chunked_from_transfer_encoding();
@@ -68,12 +72,11 @@ namespace HTTPRequest {
 
         bool _is_method_supported(const std::string &method);
         size_t _longest_method_size();
-        std::string _convert_header_name_touppercase(std::string& header_name);
         void _throw_request_exception(HTTPResponse::StatusCode error_status);
         
         struct Dispatch {
             State parsing_state;
-            void (RequestParser::*ptr)(std::string& line);
+            void (RequestParser::*ptr)(const Utility::StringView& line);
         };
 
         static Dispatch _dispatch_table[];
@@ -87,8 +90,10 @@ namespace HTTPRequest {
         RequestParser(const RequestParser& other);
         ~RequestParser();
 
-        void parse_HTTP_request(char* buffer, size_t bytes_read);
+        void set_delegate(RequestParserDelegate* delegate);
+        size_t parse_HTTP_request(char* buffer, size_t bytes_read);
         bool is_parsing_finished();
+        void reset();
     };
 }
 
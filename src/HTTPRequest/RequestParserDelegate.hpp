@@ -0,0 +1,20 @@
+#ifndef REQUESTPARSERDELEGATE_HPP
+#define REQUESTPARSERDELEGATE_HPP
+
+namespace HTTPRequest {
+    struct BodyLimits {
+        long max_size; // client_max_body_size
+        long buffer_size; // client_body_buffer_size, a bigger body goes to a temporary file
+    };
+
+    // Asked once the headers are there: which limits apply depends on the server and location the request is for.
+    class RequestParserDelegate {
+
+    public:
+        virtual ~RequestParserDelegate() {}
+
+        virtual BodyLimits get_body_limits() = 0;
+    };
+}
+
+#endif
@@ -1,87 +1,89 @@
 #include "RequestReader.hpp"
 
+#include <cstring> // for memchr
+
 #include "../HTTP/Exceptions/RequestException.hpp"
 #include "../Constants.hpp"
 
 namespace HTTPRequest {
 
 
-    RequestReader::RequestReader() : _accumulator(""), _length_counter(0) {}
+    RequestReader::RequestReader() : _accumulator(""), _length_counter(0), _accumulated_line_taken(false) {}
 
     RequestReader::~RequestReader() {}
 
-    bool RequestReader::_is_end_of_line(char character) {
-        return (character == '\n' && _accumulator.size() > 1  && _accumulator[_accumulator.size() - 2] == '\r');
-    }
-
-    bool RequestReader::_is_end_of_chunk(char* buffer, size_t bytes_accumulated) {
-        return ((buffer + bytes_accumulated) && buffer[bytes_accumulated] == '\r' 
-                && (buffer + bytes_accumulated + 1) && buffer[bytes_accumulated + 1] == '\n');
+    void RequestReader::reset() {
+        _accumulator.clear();
+        _length_counter = 0;
+        _accumulated_line_taken = false;
     }
 
-    std::string RequestReader::read_line(char* buffer, size_t bytes_read, size_t* bytes_accumulated, bool* can_be_parsed) { // pointer to the buffer as we need to keep track of it
-        while (*bytes_accumulated != bytes_read)
-        {
-            if (RequestReader::_length_counter > Constants::DEFAULT_MAX_SIZE_BODY) {
-                throw Exception::RequestException(HTTPResponse::ContentTooLarge);
+    // the '\n' of the first CRLF, the '\r' may be the last byte of the previous read
+    const char *RequestReader::_find_end_of_line(const char *start, size_t size) const {
+        const char *position = start;
+        const char *end = start + size;
+        while (position != end) {
+            const char *new_line = static_cast<const char *>(std::memchr(position, '\n', end - position));
+            if (new_line == NULL) {
+                return NULL;
+            }
+            if (new_line != start && new_line[-1] == '\r') {
+                return new_line;
             }
-            char current_character = buffer[*bytes_accumulated];
-                _accumulator.append(1, current_character);
-                *bytes_accumulated += 1;
-                RequestReader::_length_counter++;
-            if (_is_end_of_line(current_character)) {
-                *can_be_parsed = true;
-                std::string line = _accumulator.substr(0, _accumulator.size());
-                _accumulator.resize(0);
-                return line;
+            if (new_line == start && !_accumulator.empty() && _accumulator[_accumulator.size() - 1] == '\r') {
+                return new_line;
             }
+            position = new_line + 1;
         }
-        return _accumulator;
+        return NULL;
     }
 
-    std::string RequestReader::read_chunk(ssize_t chunk_size, char* buffer, size_t bytes_read, size_t* bytes_accumulated, bool* can_be_parsed) { // pointer to the buffer as we need to keep track of it
-        while (*bytes_accumulated != bytes_read)
-        {
-            if (RequestReader::_length_counter > Constants::DEFAULT_MAX_SIZE_BODY) {
-                throw Exception::RequestException(HTTPResponse::ContentTooLarge);
-            }
-            char current_character = buffer[*bytes_accumulated];
-            if (chunk_size > 0) {
-                _accumulator.append(1, current_character);
-                *bytes_accumulated += 1;
-                RequestReader::_length_counter++;
-                chunk_size--;
-            }
-            else {
-                if (_is_end_of_chunk(buffer, *bytes_accumulated)) {
-                    *can_be_parsed = true;
-                    std::string line = _accumulator.substr(0, _accumulator.size());
-                    *bytes_accumulated += 2; // skipping \r\n
-                    _accumulator.resize(0);
-                    return line;
-                }
-            }
+    // a line may be long, not endless: the payload is limited by the parser, in its own way
+    void RequestReader::_count(size_t size) {
+        _length_counter += size;
+        if (_length_counter > static_cast<size_t>(Constants::MAX_LINE_LENGTH)) {
+            throw Exception::RequestException(HTTPResponse::RequestHeaderFieldsTooLarge);
         }
-        return _accumulator;
     }
 
-    std::string RequestReader::read_payload(char* buffer, size_t bytes_read, size_t* bytes_accumulated, bool* can_be_parsed) {
-        while (*bytes_accumulated != bytes_read)
-        {
-            if (RequestReader::_length_counter > Constants::DEFAULT_MAX_SIZE_BODY) {
-                throw Exception::RequestException(HTTPResponse::ContentTooLarge);
-            }
-            char current_character = buffer[*bytes_accumulated];
-                _accumulator.append(1, current_character);
-                *bytes_accumulated += 1;
-                RequestReader::_length_counter++;
-            if (_is_end_of_line(current_character)) {
-                *can_be_parsed = true;
-                break;
-            }
+    // true once a whole line is there, line then holds it without its CRLF
+    bool RequestReader::read_line(const char *buffer, size_t bytes_read, size_t *bytes_accumulated, Utility::StringView &line) {
+        if (_accumulated_line_taken) {
+            _accumulator.clear();
+            _accumulated_line_taken = false;
+        }
+        if (_accumulator.empty()) {
+            _length_counter = 0;
+        }
+        const char *start = buffer + *bytes_accumulated;
+        size_t available = bytes_read - *bytes_accumulated;
+        const char *end_of_line = _find_end_of_line(start, available);
+        if (end_of_line == NULL) { // the rest of the line comes with the next read, the buffer won't be there anymore
+            _count(available);
+            _accumulator.append(start, available);
+            *bytes_accumulated = bytes_read;
+            return false;
         }
-        std::string line = _accumulator.substr(0, _accumulator.size());
-        _accumulator.resize(0);
-        return line;
+        size_t length = end_of_line + 1 - start;
+        _count(length);
+        *bytes_accumulated += length;
+        if (_accumulator.empty()) {
+            line = Utility::StringView(start, length - 2);
+            return true;
+        }
+        _accumulator.append(start, length);
+        line = Utility::StringView(_accumulator.data(), _accumulator.size() - 2);
+        _accumulated_line_taken = true;
+        return true;
+    }
+
+    // up to count bytes of payload, as many as this read holds. Never reads past them: whatever
+    // follows belongs to the next pipelined request.
+    Utility::StringView RequestReader::read_bytes(const char *buffer, size_t bytes_read, size_t *bytes_accumulated, size_t count) {
+        size_t available = bytes_read - *bytes_accumulated;
+        size_t length = count < available ? count : available;
+        Utility::StringView bytes(buffer + *bytes_accumulated, length);
+        *bytes_accumulated += length;
+        return bytes;
     }
 }
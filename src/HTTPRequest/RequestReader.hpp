@@ -3,22 +3,29 @@
 #include <string>
 #include <sys/types.h>// for ssize_t
 
+#include "../Utility/StringView.hpp"
+
 namespace HTTPRequest {
+	// Cuts the received bytes into lines and runs of payload without copying them: what it hands out
+	// points into the receive buffer. Only a line that is split over several reads is put together
+	// in the accumulator, and the view then points there until the next line is read.
 	class RequestReader
 	{
 	private:
 		std::string _accumulator;
 		size_t _length_counter;
+		bool _accumulated_line_taken;
 
-		bool _is_end_of_line(char character);
-		bool _is_end_of_chunk(char *buffer, size_t bytes_accumulated);
+		const char *_find_end_of_line(const char *start, size_t size) const;
+		void _count(size_t size);
 
 	public:
 		RequestReader();
 		~RequestReader();
 
-		std::string read_line(char* buffer, size_t bytes_read, size_t* bytes_accumulated, bool* can_be_parsed);
-		std::string read_chunk(ssize_t chunk_size, char *buffer, size_t bytes_read, size_t *bytes_accumulated, bool *can_be_parsed);
-		std::string read_payload(char *buffer, size_t bytes_read, size_t *bytes_accumulated, bool *can_be_parsed);
+		void reset();
+
+		bool read_line(const char *buffer, size_t bytes_read, size_t *bytes_accumulated, Utility::StringView &line);
+		Utility::StringView read_bytes(const char *buffer, size_t bytes_read, size_t *bytes_accumulated, size_t count);
 	};
 }
@@ -0,0 +1,39 @@
+#include "HeaderCache.hpp"
+#include "../Constants.hpp"
+
+namespace HTTPResponse {
+
+	pthread_mutex_t HeaderCache::_mutex = PTHREAD_MUTEX_INITIALIZER;
+	HeaderCache::EntryMap HeaderCache::_entries;
+	std::list<std::string> HeaderCache::_lru;
+
+	bool HeaderCache::find(const std::string &path, time_t mtime, off_t size, Utility::SharedBuffer &head) {
+		pthread_mutex_lock(&_mutex);
+		EntryMap::iterator it = _entries.find(path);
+		bool found = it != _entries.end() && it->second.mtime == mtime && it->second.size == size;
+		if (found) {
+			_lru.splice(_lru.begin(), _lru, it->second.lru_position);
+			head = it->second.head;
+		}
+		pthread_mutex_unlock(&_mutex);
+		return found;
+	}
+
+	void HeaderCache::insert(const std::string &path, time_t mtime, off_t size, const Utility::SharedBuffer &head) {
+		pthread_mutex_lock(&_mutex);
+		EntryMap::iterator it = _entries.find(path);
+		if (it == _entries.end()) {
+			if (_entries.size() >= static_cast<size_t>(Constants::HEADER_CACHE_ENTRIES)) {
+				_entries.erase(_lru.back());
+				_lru.pop_back();
+			}
+			_lru.push_front(path);
+			it = _entries.insert(std::make_pair(path, Entry())).first;
+			it->second.lru_position = _lru.begin();
+		}
+		it->second.mtime = mtime;
+		it->second.size = size;
+		it->second.head = head;
+		pthread_mutex_unlock(&_mutex);
+	}
+}
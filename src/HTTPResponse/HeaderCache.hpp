@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <list>
+#include <ctime>
+#include <cstddef>
+#include <sys/types.h> // for off_t
+#include <pthread.h>
+
+#include "../Utility/SharedBuffer.hpp"
+
+namespace HTTPResponse {
+
+	// Ready-made status lines and headers of static files, shared by every server of the process.
+	// A block only depends on the file, so it is keyed by path and only used while the mtime and
+	// size still match; the headers of each response (Date, Connection) are serialized after it.
+	class HeaderCache
+	{
+	public:
+		static bool find(const std::string &path, time_t mtime, off_t size, Utility::SharedBuffer &head);
+		static void insert(const std::string &path, time_t mtime, off_t size, const Utility::SharedBuffer &head);
+
+	private:
+		struct Entry
+		{
+			time_t mtime;
+			off_t size;
+			Utility::SharedBuffer head;
+			std::list<std::string>::iterator lru_position;
+		};
+		typedef std::map<std::string, Entry> EntryMap;
+
+		static pthread_mutex_t _mutex;
+		static EntryMap _entries;
+		static std::list<std::string> _lru; // most recently used first
+
+		HeaderCache();
+	};
+}
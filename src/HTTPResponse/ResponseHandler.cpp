@@ -1,19 +1,93 @@
 #include "ResponseHandler.hpp"
 #include "../Utility/Utility.hpp"
+#include "../Utility/ContentCache.hpp"
+#include "HeaderCache.hpp"
+#include "../HTTPRequest/MultipartParser.hpp"
 #include "../Constants.hpp"
 
 #include <sstream> // for converting int to string
+#include <iomanip> // for the multipart boundary
+#include <ctime>
+#include <algorithm> // for std::transform
+#include <cctype> // for ::tolower
+#include <cstdlib> // for strtod
+#include <unistd.h> // for close
 #include <fstream>  // for ofstream
 #include <string.h> //for strerror
+#include <sys/stat.h> // for S_ISREG
+#include <cstdio> // for remove
 
-#include <sys/event.h>//kqueue
+namespace HTTPResponse {
+	namespace {
+		// Writes the file parts of a multipart body into the upload directory while the parser goes
+		// through it, the content of a part never has to be in memory as a whole. Plain form fields
+		// (parts without a file name) are skipped.
+		class UploadWriter : public HTTPRequest::MultipartParserDelegate
+		{
+		public:
+			explicit UploadWriter(const std::string &directory) : _directory(directory), _failed(false) {}
+
+			bool begin_part(const HTTPRequest::MultipartPart &part) {
+				std::string name = part.filename.substr(part.filename.find_last_of("/\\") + 1); // never outside of the directory
+				if (name.empty() || name == "." || name == "..")
+					return true;
+				std::string path = _directory + "/" + name;
+				_stream.open(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+				if (!_stream.is_open()) {
+					_failed = true;
+					return false;
+				}
+				_created_files.push_back(path);
+				return true;
+			}
 
-size_t loop_redirection = 0;
+			bool part_data(const char *data, size_t size) {
+				if (!_stream.is_open())
+					return true;
+				_stream.write(data, size);
+				_failed = !_stream.good();
+				return !_failed;
+			}
+
+			bool end_part() {
+				if (!_stream.is_open())
+					return true;
+				_stream.close();
+				Utility::OpenFileCache::invalidate(_created_files.back());
+				_failed = _stream.fail();
+				return !_failed;
+			}
+
+			// what was written of a body that turned out to be broken is not kept
+			void remove_files() {
+				if (_stream.is_open())
+					_stream.close();
+				for (size_t i = 0; i < _created_files.size(); i++) {
+					std::remove(_created_files[i].c_str());
+					Utility::OpenFileCache::invalidate(_created_files[i]);
+				}
+				_created_files.clear();
+			}
+
+			const std::vector<std::string> &get_created_files() const { return _created_files; }
+			bool has_failed() const { return _failed; }
+
+		private:
+			std::string _directory;
+			std::ofstream _stream;
+			std::vector<std::string> _created_files;
+			bool _failed;
+
+			UploadWriter(const UploadWriter &other);
+			UploadWriter &operator=(const UploadWriter &other);
+		};
+	}
 
-namespace HTTPResponse {
 	ResponseHandler::ResponseHandler(HTTPRequest::RequestMessage* request_message, ResponseMessage* response_message)
 	: _http_request_message(request_message)
 	, _http_response_message(response_message)
+	, _keep_alive(false)
+	, _redirections(0)
 	{
 	}
 
@@ -26,6 +100,8 @@ namespace HTTPResponse {
 		_http_response_message = other._http_response_message;
 		_config = other._config;
 		_file = other._file;
+		_keep_alive = other._keep_alive;
+		_redirections = other._redirections;
         return *this;
     }
 
@@ -37,8 +113,10 @@ namespace HTTPResponse {
 		Utility::logger(request_info(), YELLOW);
 		try{
 			cgi_handler.prepare_cgi_data(_http_request_message, _config, socket_fd);
-			if(cgi_handler.get_search_cgi_extention_result())//if the cgi extention was found in the list, execute cgi and skip the further process
+			if(cgi_handler.get_search_cgi_extention_result()) {//if the cgi extention was found in the list, execute cgi and skip the further process
+				_set_connection_header(); // the cgi response headers are completed in the server once the script output is read
 				return false;
+			}
 		}
 		catch(std::exception){
 			handle_error(InternalServerError);
@@ -57,13 +135,13 @@ namespace HTTPResponse {
 		}
 
 		//redirection: server stops processing, responds with redirected location
-		if (!_config.get_return().empty() && loop_redirection < 10) {
+		if (!_config.get_return().empty() && _redirections < 10) {
 			_handle_redirection();
 			return true;
 		}
 
-		if (loop_redirection == 10) { //redirection is limited to 10 times
-			loop_redirection = 0;
+		if (_redirections == 10) { //redirection is limited to 10 times
+			_redirections = 0;
 		}
 
 		//HTTP method handling
@@ -73,7 +151,7 @@ namespace HTTPResponse {
 
 	void ResponseHandler::_handle_redirection()
 	{
-		loop_redirection++;
+		_redirections++;
 
 		//get the redirection information
 			//the return directive applies only inside the topmost context it’s defined in
@@ -137,28 +215,333 @@ namespace HTTPResponse {
 		_http_response_message->set_header_element("Last-Modified", _file.last_modified_info());
 		_http_response_message->set_status_code("200");
 		_http_response_message->set_reason_phrase("OK");
+		_compress_response("text/html");
 		_build_final_response();
 	}
 
 	void ResponseHandler::_serve_found_file(const std::string &str) {
-		_http_response_message->set_message_body(_file.get_content(str));
-		if (_http_response_message->get_message_body() == "Forbidden")
-			return (handle_error(Forbidden));
+		std::string path = str;
+		std::string encoding;
+		if (_config.get_static_precompressed() == ON) {
+			_http_response_message->set_header_element("Vary", "Accept-Encoding");
+			if (!_http_request_message->has_header_field(HTTPRequest::HEADER_RANGE)) // ranges are served from the original file
+				path = _precompressed_variant(str, encoding);
+		}
+		if (_http_request_message->has_header_field(HTTPRequest::HEADER_IF_NONE_MATCH) || _http_request_message->has_header_field(HTTPRequest::HEADER_IF_MODIFIED_SINCE)) {
+			Utility::OpenFileCache::Info current = Utility::OpenFileCache::lookup(path);
+			if (current.error == 0 && S_ISREG(current.mode) && _is_not_modified(current))
+				return _serve_not_modified(current, _content_type(str));
+		}
+		if (_http_request_message->get_method() == "GET" && _http_request_message->has_header_field(HTTPRequest::HEADER_RANGE) && _serve_ranges(str))
+			return;
+		Utility::OpenFileCache::Info info;
+		Utility::SharedBuffer content;
+		if (Utility::ContentCache::find(path, info, content)) // small hot files are sent from memory, shared with every other response
+			_http_response_message->set_body_buffer(content);
+		else {
+			int file_fd = _file.open_regular_file(path, info);
+			if (file_fd == Constants::ERROR)
+				return (handle_error(Forbidden));
+			_http_response_message->set_body_file(file_fd, info.size); // sent with sendfile, never read into memory
+		}
 
-		//set necessary headers
-		if (_file.get_mime_type(str) == "text/html")
-			_http_response_message->set_header_element("Content-Type",  "text/html; charset=utf-8");
-		else
-			_http_response_message->set_header_element("Content-Type", _file.get_mime_type(str));
-		_http_response_message->set_header_element("Last-Modified", _file.last_modified_info(str));
 		_http_response_message->set_status_code("200");
 		_http_response_message->set_reason_phrase("OK");
+		if (!encoding.empty())
+			_http_response_message->set_header_element("Content-Encoding", encoding);
+		bool compressed = encoding.empty() && _compress_response(_content_type(str));
+		if (compressed || _http_request_message->get_method() == "HEAD") { // the cached blocks carry the Content-Length of the file, these responses go without
+			if (!compressed)
+				_http_response_message->set_header_element("Accept-Ranges", "bytes");
+			_http_response_message->set_header_element("Content-Type", _content_type(str));
+			_http_response_message->set_header_element("Last-Modified", Utility::File::http_date(info.mtime));
+			// the compressed bytes differ from the ones of the file, only a weak validator still holds
+			_http_response_message->set_header_element("ETag", (compressed ? "W/" : "") + Utility::File::entity_tag(info.mtime, info.size));
+		}
+		else
+			_http_response_message->set_cached_head(_static_file_head(path, str, info));
+		_build_final_response();
+	}
+
+	// file.ext.br or file.ext.gz when it sits next to the file and the client takes that coding, the file itself otherwise
+	std::string ResponseHandler::_precompressed_variant(const std::string &str, std::string &encoding) {
+		static const char *variants[][2] = {{"br", ".br"}, {"gzip", ".gz"}};
+		for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+			if (!_accepts_encoding(variants[i][0]))
+				continue;
+			std::string variant = str + variants[i][1];
+			Utility::OpenFileCache::Info info = Utility::OpenFileCache::lookup(variant);
+			if (info.error == 0 && S_ISREG(info.mode)) {
+				encoding = variants[i][0];
+				return variant;
+			}
+		}
+		return str;
+	}
+
+	// With gzip on, a body of a listed type and of gzip_min_length bytes at least varies with Accept-Encoding.
+	// It is compressed for HTTP/1.1 clients that take gzip: a body in memory right away, a body file while
+	// it is sent, in chunks. HEAD gets the headers of the compressed GET without anything being deflated.
+	// Returns whether the response goes out compressed.
+	bool ResponseHandler::_compress_response(const std::string &content_type) {
+		if (!_varies_with_gzip(content_type, _http_response_message->get_body_length()))
+			return false;
+		_http_response_message->set_header_element("Vary", "Accept-Encoding");
+		if (_http_request_message->get_HTTP_version() != "HTTP/1.1" || !_accepts_encoding("gzip"))
+			return false;
+		if (_http_request_message->get_method() == "HEAD")
+			; // the body is dropped anyway
+		else if (_http_response_message->get_body_file_fd() != Constants::ERROR)
+			_http_response_message->set_gzip_level(_config.get_gzip_comp_level());
+		else if (!_http_response_message->compress_body(_config.get_gzip_comp_level()))
+			return false;
+		_http_response_message->set_header_element("Content-Encoding", "gzip");
+		return true;
+	}
+
+	// whether the body would be gzip compressed for a client that takes it
+	bool ResponseHandler::_varies_with_gzip(const std::string &content_type, off_t length) {
+		return _config.get_gzip() == ON && length >= _config.get_gzip_min_length() && _is_gzip_type(content_type);
+	}
+
+	bool ResponseHandler::_is_gzip_type(const std::string &content_type) {
+		std::string mime_type = Utility::trim_white_space(content_type.substr(0, content_type.find(';')));
+		std::transform(mime_type.begin(), mime_type.end(), mime_type.begin(), ::tolower);
+		const std::vector<std::string> &types = _config.get_gzip_types();
+		for (std::vector<std::string>::const_iterator it = types.begin(); it != types.end(); ++it) {
+			if (*it == "*" || *it == mime_type)
+				return true;
+		}
+		return false;
+	}
+
+	// "gzip, br;q=0, *;q=0.5": a weight of 0 refuses a coding, * stands for the ones that are not listed
+	bool ResponseHandler::_accepts_encoding(const std::string &coding) {
+		if (!_http_request_message->has_header_field(HTTPRequest::HEADER_ACCEPT_ENCODING))
+			return false;
+		std::vector<std::string> codings = Utility::_split_line(_http_request_message->get_header_value(HTTPRequest::HEADER_ACCEPT_ENCODING), ',');
+		bool wildcard = false;
+		for (std::vector<std::string>::iterator it = codings.begin(); it != codings.end(); ++it) {
+			std::string name = Utility::_trim(it->substr(0, it->find(';')));
+			std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+			bool refused = false;
+			size_t weight = it->find("q=");
+			if (weight == std::string::npos)
+				weight = it->find("Q=");
+			if (weight != std::string::npos && it->find(';') < weight)
+				refused = std::strtod(it->c_str() + weight + 2, NULL) == 0;
+			if (name == coding)
+				return !refused;
+			if (name == "*")
+				wildcard = !refused;
+		}
+		return wildcard;
+	}
+
+	// RFC 9110 13.2.2: If-None-Match takes precedence over If-Modified-Since
+	bool ResponseHandler::_is_not_modified(const Utility::OpenFileCache::Info &info) {
+		if (_http_request_message->has_header_field(HTTPRequest::HEADER_IF_NONE_MATCH))
+			return _matches_entity_tag(_http_request_message->get_header_value(HTTPRequest::HEADER_IF_NONE_MATCH), Utility::File::entity_tag(info.mtime, info.size));
+		time_t since;
+		return Utility::File::parse_http_date(_http_request_message->get_header_value(HTTPRequest::HEADER_IF_MODIFIED_SINCE), since) && info.mtime <= since;
+	}
+
+	// If-None-Match compares weakly: a W/ prefix on either side does not matter
+	bool ResponseHandler::_matches_entity_tag(const std::string &tags, const std::string &entity_tag) {
+		std::vector<std::string> candidates = Utility::_split_line(tags, ',');
+		for (std::vector<std::string>::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+			std::string candidate = Utility::_trim(*it);
+			if (candidate == "*")
+				return true;
+			if (candidate.compare(0, 2, "W/") == 0)
+				candidate.erase(0, 2);
+			if (candidate == entity_tag)
+				return true;
+		}
+		return false;
+	}
+
+	// the copy of the client is current, only the validators go back, and the Vary of the 200 so caches store both alike
+	void ResponseHandler::_serve_not_modified(const Utility::OpenFileCache::Info &info, const std::string &content_type) {
+		_http_response_message->set_status_code(Utility::to_string(static_cast<int>(NotModified)));
+		_http_response_message->set_reason_phrase(HTTPResponse::get_reason_phrase(NotModified));
+		if (_varies_with_gzip(content_type, info.size))
+			_http_response_message->set_header_element("Vary", "Accept-Encoding");
+		_http_response_message->set_header_element("ETag", Utility::File::entity_tag(info.mtime, info.size));
+		_http_response_message->set_header_element("Last-Modified", Utility::File::http_date(info.mtime));
 		_build_final_response();
 	}
 
+	// A 206 with the requested parts of the file, or a 416 when none of them exists. Returns false when the
+	// Range header does not apply (syntax error, too many ranges, an If-Range that does not match), then the
+	// whole file is sent as usual.
+	bool ResponseHandler::_serve_ranges(const std::string &str) {
+		Utility::OpenFileCache::Info info;
+		int file_fd = _file.open_regular_file(str, info);
+		if (file_fd == Constants::ERROR)
+			return false;
+		std::vector<std::pair<off_t, off_t> > ranges;
+		if (!_if_range_matches(info) || !_parse_ranges(_http_request_message->get_header_value(HTTPRequest::HEADER_RANGE), info.size, ranges)) {
+			close(file_fd);
+			return false;
+		}
+		if (ranges.empty()) {
+			close(file_fd);
+			_http_response_message->set_header_element("Content-Range", "bytes */" + Utility::size_to_string(info.size));
+			handle_error(RangeNotSatisfiable);
+			return true;
+		}
+		_http_response_message->set_body_file(file_fd, info.size); // the parts are sent with sendfile as well
+		if (ranges.size() == 1) {
+			_http_response_message->set_header_element("Content-Type", _content_type(str));
+			_http_response_message->set_header_element("Content-Range", _content_range(ranges[0], info.size));
+			_http_response_message->add_body_range("", ranges[0].first, ranges[0].second);
+		}
+		else {
+			std::string boundary = _multipart_boundary();
+			_http_response_message->set_header_element("Content-Type", "multipart/byteranges; boundary=" + boundary);
+			for (size_t i = 0; i < ranges.size(); i++) {
+				_http_response_message->add_body_range("\r\n--" + boundary + "\r\nContent-Type: " + _content_type(str)
+					+ "\r\nContent-Range: " + _content_range(ranges[i], info.size) + "\r\n\r\n", ranges[i].first, ranges[i].second);
+			}
+			_http_response_message->add_body_range("\r\n--" + boundary + "--\r\n", 0, 0);
+		}
+		_http_response_message->set_header_element("ETag", Utility::File::entity_tag(info.mtime, info.size));
+		_http_response_message->set_header_element("Last-Modified", Utility::File::http_date(info.mtime));
+		_http_response_message->set_status_code(Utility::to_string(static_cast<int>(PartialContent)));
+		_http_response_message->set_reason_phrase(HTTPResponse::get_reason_phrase(PartialContent));
+		_build_final_response();
+		return true;
+	}
+
+	// If-Range compares strongly with the ETag, or exactly with the Last-Modified date
+	bool ResponseHandler::_if_range_matches(const Utility::OpenFileCache::Info &info) {
+		if (!_http_request_message->has_header_field(HTTPRequest::HEADER_IF_RANGE))
+			return true;
+		const std::string &validator = _http_request_message->get_header_value(HTTPRequest::HEADER_IF_RANGE);
+		if (!validator.empty() && validator[0] == '"')
+			return validator == Utility::File::entity_tag(info.mtime, info.size);
+		time_t date;
+		return Utility::File::parse_http_date(validator, date) && date == info.mtime;
+	}
+
+	// "bytes=0-499, 500-, -200" into [start, end) pairs within size. Unsatisfiable ranges are left out,
+	// false on a syntax error or more ranges than MAX_RANGES.
+	bool ResponseHandler::_parse_ranges(const std::string &value, off_t size, std::vector<std::pair<off_t, off_t> > &ranges) {
+		if (value.compare(0, 6, "bytes=") != 0)
+			return false;
+		std::vector<std::string> specs = Utility::_split_line(value.substr(6), ',');
+		if (specs.empty() || specs.size() > static_cast<size_t>(Constants::MAX_RANGES))
+			return false;
+		for (std::vector<std::string>::iterator it = specs.begin(); it != specs.end(); ++it) {
+			std::string spec = Utility::_trim(*it);
+			size_t dash = spec.find('-');
+			if (dash == std::string::npos)
+				return false;
+			std::string first = spec.substr(0, dash);
+			std::string last = spec.substr(dash + 1);
+			off_t start;
+			off_t end;
+			if (first.empty()) { // the last bytes of the file
+				off_t suffix;
+				if (!_parse_offset(last, suffix))
+					return false;
+				start = suffix < size ? size - suffix : 0;
+				end = size;
+				if (suffix == 0)
+					continue;
+			}
+			else {
+				if (!_parse_offset(first, start))
+					return false;
+				end = size;
+				if (!last.empty()) {
+					if (!_parse_offset(last, end) || end < start)
+						return false;
+					end = end + 1 < size ? end + 1 : size;
+				}
+			}
+			if (start < size)
+				ranges.push_back(std::make_pair(start, end));
+		}
+		return _merge_ranges(ranges, size);
+	}
+
+	// Overlapping or repeated ranges would send the same bytes several times: when they add up to more
+	// than the file the whole file is sent instead (like nginx does), the others are sorted and the
+	// ones that overlap or touch are joined.
+	bool ResponseHandler::_merge_ranges(std::vector<std::pair<off_t, off_t> > &ranges, off_t size) {
+		off_t total = 0;
+		for (size_t i = 0; i < ranges.size(); i++)
+			total += ranges[i].second - ranges[i].first;
+		if (total > size)
+			return false;
+		std::sort(ranges.begin(), ranges.end());
+		size_t merged = 0;
+		for (size_t i = 1; i < ranges.size(); i++) {
+			if (ranges[i].first <= ranges[merged].second)
+				ranges[merged].second = std::max(ranges[merged].second, ranges[i].second);
+			else
+				ranges[++merged] = ranges[i];
+		}
+		if (!ranges.empty())
+			ranges.resize(merged + 1);
+		return true;
+	}
+
+	bool ResponseHandler::_parse_offset(const std::string &str, off_t &offset) {
+		if (str.empty() || str.size() > 18 || str.find_first_not_of("0123456789") != std::string::npos)
+			return false;
+		offset = 0;
+		for (size_t i = 0; i < str.size(); i++)
+			offset = offset * 10 + (str[i] - '0');
+		return true;
+	}
+
+	std::string ResponseHandler::_content_range(const std::pair<off_t, off_t> &range, off_t size) {
+		return "bytes " + Utility::size_to_string(range.first) + "-" + Utility::size_to_string(range.second - 1) + "/" + Utility::size_to_string(size);
+	}
+
+	// unique enough not to show up in the parts, the same way nginx numbers them
+	std::string ResponseHandler::_multipart_boundary() {
+		static unsigned int counter = 0;
+		unsigned int sequence = __sync_add_and_fetch(&counter, 1);
+		std::ostringstream boundary;
+		boundary << std::setfill('0') << std::setw(10) << static_cast<unsigned long>(std::time(NULL)) << std::setw(10) << sequence;
+		return boundary.str();
+	}
+
+	// The status line and the headers that only depend on the file, built once per version of it.
+	// Date and Connection are added for every response.
+	// path is the file that is sent, str the one that names the type, they differ for precompressed variants
+	Utility::SharedBuffer ResponseHandler::_static_file_head(const std::string &path, const std::string &str, const Utility::OpenFileCache::Info &info) {
+		Utility::SharedBuffer head;
+		if (HeaderCache::find(path, info.mtime, info.size, head))
+			return head;
+		std::string block;
+		block.reserve(256);
+		block.append(_http_response_message->get_HTTP_version()).append(" 200 OK\r\n");
+		block.append("Accept-Ranges: bytes\r\n");
+		block.append("Content-Length: ").append(Utility::size_to_string(info.size)).append("\r\n");
+		block.append("Content-Type: ").append(_content_type(str)).append("\r\n");
+		block.append("ETag: ").append(Utility::File::entity_tag(info.mtime, info.size)).append("\r\n");
+		block.append("Last-Modified: ").append(Utility::File::http_date(info.mtime)).append("\r\n");
+		block.append("Server: HungerWeb/1.0\r\n");
+		head = Utility::SharedBuffer(block);
+		HeaderCache::insert(path, info.mtime, info.size, head);
+		return head;
+	}
+
+	std::string ResponseHandler::_content_type(const std::string &str) {
+		std::string mime_type = _file.get_mime_type(str);
+		if (mime_type == "text/html")
+			return "text/html; charset=utf-8";
+		return mime_type;
+	}
+
 	void ResponseHandler::_upload_file(void) { //POST will upload a new resource
 		//if there is nothing to upload in request body
-		if (_http_request_message->get_message_body().empty())
+		if (_http_request_message->get_payload_size() == 0)
 			return handle_error(BadRequest);
 		//URI will only hold directory info and should not point to an existing file
 		if (!_file.exists())
@@ -169,18 +552,20 @@ namespace HTTPResponse {
 		//get the upload_dir from config and create it
 		if (!_file.create_dir(_file.get_path() + "/"  + _config.get_upload_dir()))
 			return handle_error(InternalServerError);
+		if (!_http_request_message->get_multipart_boundary().empty())
+			return _upload_multipart(_file.get_path() + "/"  + _config.get_upload_dir());
 
 		//extract file name from content-disposition or create randomly named files
 		std::string path_and_name;
-		if(_http_request_message->has_header_field("CONTENT_DISPOSITION"))
-			path_and_name = _file.get_path() + "/"  + _config.get_upload_dir() + "/" + _file.extract_file_name(_http_request_message->get_header_value("CONTENT_DISPOSITION"));
-		else if (_http_request_message->has_header_field("CONTENT_TYPE")) {
+		if(_http_request_message->has_header_field(HTTPRequest::HEADER_CONTENT_DISPOSITION))
+			path_and_name = _file.get_path() + "/"  + _config.get_upload_dir() + "/" + _file.extract_file_name(_http_request_message->get_header_value(HTTPRequest::HEADER_CONTENT_DISPOSITION));
+		else if (_http_request_message->has_header_field(HTTPRequest::HEADER_CONTENT_TYPE)) {
 			path_and_name = _file.get_path() + "/"  + _config.get_upload_dir() + "/" +
 			_file.random_name_creator(_file.get_path() + "/"  + _config.get_upload_dir()) +
-			 "." + _file.get_extension(_http_request_message->get_header_value("CONTENT_TYPE"));
+			 "." + _file.get_extension(_http_request_message->get_header_value(HTTPRequest::HEADER_CONTENT_TYPE));
 		}
 
-		if(_http_request_message->has_header_field("CONTENT_TYPE") && _file.get_extension(_http_request_message->get_header_value("CONTENT_TYPE")) == "NotSupported")
+		if(_http_request_message->has_header_field(HTTPRequest::HEADER_CONTENT_TYPE) && _file.get_extension(_http_request_message->get_header_value(HTTPRequest::HEADER_CONTENT_TYPE)) == "NotSupported")
 			return handle_error(UnsupportedMediaType);
 
 		//create the new resource with the path and put request body inside
@@ -191,14 +576,52 @@ namespace HTTPResponse {
 			return handle_error(InternalServerError);
 		}
 
-		file_stream << _http_request_message->get_message_body();
+		if (!_http_request_message->write_payload(file_stream))
+			return handle_error(InternalServerError);
+		Utility::OpenFileCache::invalidate(path_and_name);
+		_build_created_response(path_and_name);
+	}
 
-		// set up response for uploading
+	// one pass over the body, wherever it is stored: every file part goes straight into its own file
+	void ResponseHandler::_upload_multipart(const std::string &upload_dir) {
+		UploadWriter writer(upload_dir);
+		HTTPRequest::MultipartParser parser(_http_request_message->get_multipart_boundary(), writer);
+		if (_http_request_message->get_payload_fd() == -1) {
+			const std::string &body = _http_request_message->get_message_body();
+			parser.feed(body.data(), body.size());
+		}
+		else {
+			char buffer[Constants::BODY_READ_SIZE];
+			size_t offset = 0;
+			while (offset < _http_request_message->get_payload_size() && !parser.is_finished() && !parser.is_failed()) {
+				ssize_t bytes_read = _http_request_message->read_payload(offset, buffer, sizeof(buffer));
+				if (bytes_read == Constants::ERROR) {
+					writer.remove_files();
+					return handle_error(InternalServerError);
+				}
+				parser.feed(buffer, bytes_read);
+				offset += bytes_read;
+			}
+		}
+		if (writer.has_failed()) {
+			writer.remove_files();
+			return handle_error(InternalServerError);
+		}
+		if (!parser.is_finished()) { // cut off or malformed
+			writer.remove_files();
+			return handle_error(BadRequest);
+		}
+		if (writer.get_created_files().empty()) //no file among the parts
+			return handle_error(BadRequest);
+		_build_created_response(writer.get_created_files().front());
+	}
+
+	void ResponseHandler::_build_created_response(const std::string &path) {
 		_http_response_message->set_message_body("<h1><center> Successfully created file! </center></h1>");
 		_http_response_message->set_header_element("Content-Type", "text/html; charset=utf-8");
 		_http_response_message->set_status_code("201");
 		_http_response_message->set_reason_phrase("Created");
-		_http_response_message->set_header_element("Location", path_and_name);
+		_http_response_message->set_header_element("Location", path);
 		_build_final_response();
 	}
 
@@ -270,40 +693,45 @@ namespace HTTPResponse {
 
 	void ResponseHandler::_build_final_response()
 	{
-		std::string response;
-		std::string msg_body = _http_response_message->get_message_body();
+		bool has_body_file = _http_response_message->get_body_file_fd() != Constants::ERROR;
+		bool has_cached_head = !_http_response_message->get_cached_head().empty();
 
 		// set any remaining headers
-		if(_http_request_message->get_method() != "HEAD")
-			_http_response_message->set_header_element("Content-Length", Utility::to_string(msg_body.length()));
-		_http_response_message->set_header_element("Date", Utility::get_formatted_date());
-		_http_response_message->set_header_element("Server", "HungerWeb/1.0");
-
-		// build status line
-		response += _http_response_message->get_HTTP_version() + " ";
-		response += _http_response_message->get_status_code() + " ";
-		response += _http_response_message->get_reason_phrase() + "\r\n";
-
-		// add all the headers to response. Format is {Header}: {Header value} \r\n
-		std::map<std::string, std::string>::const_iterator it;
-		for (it = _http_response_message->get_response_headers().begin(); it != _http_response_message->get_response_headers().end(); it++) {
-			if (!it->first.empty())
-				response += it->first + ": " + it->second;
-			response += "\r\n";
+		if (has_cached_head) {
+			// Content-Length and Server are in the cached block already
 		}
+		else if (_http_response_message->get_status_code() == "304") {
+			// never has a body, a Content-Length would describe the one of the 200
+		}
+		else if (_http_request_message->get_method() != "HEAD" && has_body_file && _http_response_message->get_gzip_level() != 0)
+			_http_response_message->set_header_element("Transfer-Encoding", "chunked"); // the compressed length is only known at the end
+		else if(_http_request_message->get_method() != "HEAD")
+			_http_response_message->set_header_element("Content-Length", Utility::size_to_string(_http_response_message->get_body_length()));
+		else { // only the headers go out
+			if (has_body_file)
+				_http_response_message->set_body_file(Constants::ERROR, 0);
+			_http_response_message->set_body_buffer(Utility::SharedBuffer());
+			_http_response_message->set_message_body("");
+		}
+		_http_response_message->set_header_element("Date", Utility::get_formatted_date());
+		if (!has_cached_head)
+			_http_response_message->set_header_element("Server", "HungerWeb/1.0");
+		_set_connection_header();
 
-		// if body is not empty add it to  response. Format: \r\n {body}
-		response += "\r\n";
-		if(!msg_body.empty() && _http_request_message->get_method() != "HEAD")
-			response += msg_body;
-
-		//final step
-		_http_response_message->append_complete_response(response);
+		// the status line and the headers, the body stays where it is and goes out next to them
+		_http_response_message->serialize_head(true);
 
 		//log
 		Utility::logger(response_status(), PURPLE);
 	}
 
+	void ResponseHandler::_set_connection_header() {
+		if (_keep_alive)
+			_http_response_message->set_header_element("Connection", "keep-alive");
+		else
+			_http_response_message->set_header_element("Connection", "close");
+	}
+
 	bool ResponseHandler::_verify_method(const std::vector<std::string> methods) {
 		if (methods.empty())
 			return true;
@@ -315,7 +743,7 @@ namespace HTTPResponse {
 	}
 
 	bool ResponseHandler::_check_client_body_size() {
-		int body_size = _http_request_message->get_message_body().size();
+		long body_size = _http_request_message->get_payload_size();
 		if (body_size > _config.get_client_max_body_size())
 			return false;
 		return true;
@@ -339,10 +767,17 @@ namespace HTTPResponse {
 		_config.set_index_page(virtual_server->get_index_page()); //if loc has index, this will be overwritten
 		_config.set_return_value(virtual_server->get_return()); //returns are appended within levels
 		_config.set_extention_list(virtual_server->get_extention_list());
+		_config.set_gzip(virtual_server->get_gzip());
+		if (virtual_server->get_gzip() == ON) { // the rest is only looked at with gzip on
+			_config.set_gzip_types(virtual_server->get_gzip_types());
+			_config.set_gzip_min_length(virtual_server->get_gzip_min_length());
+			_config.set_gzip_comp_level(virtual_server->get_gzip_comp_level());
+		}
 		if(location) { //location specific config rules, appends and overwrites
 			_config.set_limit_except(location->get_limit_except());
 			_config.set_methods_line(location->get_limit_except());
 			_config.set_autoindex(location->get_autoindex());
+			_config.set_static_precompressed(location->get_static_precompressed());
 			_config.set_route(location->get_route());
 			_config.set_upload_dir(location->get_upload_dir());
 			if (!location->get_root().empty())
@@ -353,6 +788,61 @@ namespace HTTPResponse {
 		}
 	}
 
+	// The CGI output brings its own headers, they go out behind the ones of the server and the rest is the
+	// body. It is compressed like any other body when the script names a type to compress.
+	void ResponseHandler::set_cgi_response(std::string &output) {
+		std::size_t position = output.find("\r\n\r\n");
+		std::size_t head_length = (position == std::string::npos) ? 0 : position + 4;
+		_http_response_message->set_status_code("200");
+		_http_response_message->set_reason_phrase("OK");
+		if (head_length != 0 && _config.get_gzip() == ON)
+			_compress_cgi_body(output, head_length);
+		_http_response_message->set_header_element("Server", "HungerWeb/1.0");
+		_http_response_message->set_header_element("Date", Utility::get_formatted_date());
+		_http_response_message->set_header_element("Content-Length", Utility::to_string(output.size() - head_length));
+		_http_response_message->serialize_head(false);
+		_http_response_message->swap_message_body(output);
+	}
+
+	void ResponseHandler::_compress_cgi_body(std::string &output, std::size_t head_length) {
+		std::string head = output.substr(0, head_length);
+		if (!_cgi_header_value(head, "content-encoding").empty()) // the script compressed it already
+			return;
+		std::string body = output.substr(head_length);
+		_http_response_message->swap_message_body(body);
+		if (_compress_response(_cgi_header_value(head, "content-type"))) {
+			output.swap(head);
+			output.append(_http_response_message->get_message_body());
+		}
+		_http_response_message->set_message_body("");
+	}
+
+	// a header of the CGI output by its lowercase name, empty when the script did not send it
+	std::string ResponseHandler::_cgi_header_value(const std::string &head, const std::string &name) {
+		std::vector<std::string> lines = Utility::_split_line(head, '\n');
+		for (std::vector<std::string>::iterator it = lines.begin(); it != lines.end(); ++it) {
+			std::size_t colon = it->find(':');
+			if (colon == std::string::npos)
+				continue;
+			std::string field = Utility::trim_white_space(it->substr(0, colon));
+			std::transform(field.begin(), field.end(), field.begin(), ::tolower);
+			if (field == name)
+				return Utility::trim_white_space(it->substr(colon + 1));
+		}
+		return "";
+	}
+
+	void ResponseHandler::set_keep_alive(bool keep_alive) {
+		_keep_alive = keep_alive;
+	}
+
+	// config rules and the target file are request specific, a persistent connection needs them cleared between requests
+	void ResponseHandler::reset() {
+		_config = SpecifiedConfig();
+		_file = Utility::File();
+		_keep_alive = false;
+	}
+
 	std::string ResponseHandler::response_status() {
 		std::string tmp;
 
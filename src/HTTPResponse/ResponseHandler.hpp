@@ -21,6 +21,8 @@ namespace HTTPResponse
 		ResponseMessage *_http_response_message;
 		SpecifiedConfig _config;
 		Utility::File _file;
+		bool _keep_alive;
+		size_t _redirections; // followed on this connection, kept across its requests to stop a redirect loop
 
 		bool _verify_method(const std::vector<std::string> methods);
 		const std::string& _create_allowed_methods_line(const std::vector<std::string> methods);
@@ -29,11 +31,33 @@ namespace HTTPResponse
 		void _serve_file(void);
 		void _serve_directory(void);
 		void _serve_found_file(const std::string &str);
+		Utility::SharedBuffer _static_file_head(const std::string &path, const std::string &str, const Utility::OpenFileCache::Info &info);
+		std::string _content_type(const std::string &str);
+		std::string _precompressed_variant(const std::string &str, std::string &encoding);
+		bool _accepts_encoding(const std::string &coding);
+		bool _compress_response(const std::string &content_type);
+		bool _is_gzip_type(const std::string &content_type);
+		bool _varies_with_gzip(const std::string &content_type, off_t length);
+		void _compress_cgi_body(std::string &output, std::size_t head_length);
+		std::string _cgi_header_value(const std::string &head, const std::string &name);
+		bool _is_not_modified(const Utility::OpenFileCache::Info &info);
+		bool _matches_entity_tag(const std::string &tags, const std::string &entity_tag);
+		void _serve_not_modified(const Utility::OpenFileCache::Info &info, const std::string &content_type);
+		bool _serve_ranges(const std::string &str);
+		bool _if_range_matches(const Utility::OpenFileCache::Info &info);
+		bool _parse_ranges(const std::string &value, off_t size, std::vector<std::pair<off_t, off_t> > &ranges);
+		bool _merge_ranges(std::vector<std::pair<off_t, off_t> > &ranges, off_t size);
+		bool _parse_offset(const std::string &str, off_t &offset);
+		std::string _content_range(const std::pair<off_t, off_t> &range, off_t size);
+		std::string _multipart_boundary();
 		void _serve_custom_error_page(const std::string &str);
 		bool _search_for_index_page();
 		void _delete_file(void);
 		void _upload_file(void);
+		void _upload_multipart(const std::string &upload_dir);
+		void _build_created_response(const std::string &path);
 		void _build_final_response();
+		void _set_connection_header();
 		void _build_final_cgi_response(std::string &cgi_response);
 		void _handle_redirection();
 
@@ -48,6 +72,9 @@ namespace HTTPResponse
 		void handle_error(HTTPResponse::StatusCode code);
 		std::string handle_cgi(int fd, int kq);
 		void set_config_rules(const Config::ServerBlock *virtual_server, const Config::LocationBlock *location);
+		void set_cgi_response(std::string &output);
+		void set_keep_alive(bool keep_alive);
+		void reset();
 
 		/* logger helpers */
 		std::string response_status();
@@ -1,10 +1,17 @@
 #include "ResponseMessage.hpp"
 
+#include <unistd.h> // for close
+
+#include "../Utility/Deflater.hpp"
+
 namespace HTTPResponse {
     ResponseMessage::ResponseMessage()
         : _HTTP_version("HTTP/1.1")
         , _status_code("")
         , _reason_phrase("")
+        , _body_file_fd(-1)
+        , _body_file_size(0)
+        , _gzip_level(0)
     {}
 
     ResponseMessage::ResponseMessage(const ResponseMessage& other)
@@ -12,11 +19,32 @@ namespace HTTPResponse {
         , _status_code(other._status_code)
         , _reason_phrase(other._reason_phrase)
         , _message_body(other._message_body)
-        , _complete_response(other._complete_response)
+        , _serialized_head(other._serialized_head)
+        , _cached_head(other._cached_head)
+        , _body_file_fd(-1) // the file stays with the original
+        , _body_file_size(0)
+        , _body_ranges(other._body_ranges)
+        , _body_buffer(other._body_buffer)
+        , _gzip_level(other._gzip_level)
         , _response_headers(other._response_headers)
     {}
 
-    ResponseMessage::~ResponseMessage() {}
+    ResponseMessage::~ResponseMessage() {
+        set_body_file(-1, 0);
+    }
+
+    void ResponseMessage::reset() {
+        set_body_file(-1, 0);
+        _body_ranges.clear();
+        _body_buffer.reset();
+        _gzip_level = 0;
+        _status_code.clear();
+        _reason_phrase.clear();
+        _message_body.clear();
+        _serialized_head.clear();
+        _cached_head.reset();
+        _response_headers.clear();
+    }
 
     void ResponseMessage::set_status_code(const std::string& code) {
         _status_code = code;
@@ -30,12 +58,86 @@ namespace HTTPResponse {
         _message_body = body;
     }
 
-    void ResponseMessage::set_complete_response(const std::string& response) {
-        _complete_response = response;
+    void ResponseMessage::swap_message_body(std::string& body) {
+        _message_body.swap(body);
+    }
+
+    // Writes the status line and the headers into one buffer sized up front. Without end_header_section
+    // the empty line is left out, for a body that brings headers of its own (the output of a CGI).
+    // With a cached head, the status line is in there and only the headers of the map are written.
+    void ResponseMessage::serialize_head(bool end_header_section) {
+        std::map<std::string, std::string>::const_iterator it;
+        bool status_line = _cached_head.empty();
+        size_t size = 2;
+        if (status_line)
+            size += _HTTP_version.size() + 1 + _status_code.size() + 1 + _reason_phrase.size() + 2;
+        for (it = _response_headers.begin(); it != _response_headers.end(); it++) {
+            if (!it->first.empty())
+                size += it->first.size() + 2 + it->second.size();
+            size += 2;
+        }
+        _serialized_head.clear();
+        _serialized_head.reserve(size);
+        if (status_line) {
+            _serialized_head.append(_HTTP_version).append(1, ' ');
+            _serialized_head.append(_status_code).append(1, ' ');
+            _serialized_head.append(_reason_phrase).append("\r\n");
+        }
+        // Format is {Header}: {Header value} \r\n
+        for (it = _response_headers.begin(); it != _response_headers.end(); it++) {
+            if (!it->first.empty())
+                _serialized_head.append(it->first).append(": ").append(it->second);
+            _serialized_head.append("\r\n");
+        }
+        if (end_header_section)
+            _serialized_head.append("\r\n");
+    }
+
+    // the message owns the fd until the finished response takes it over
+    void ResponseMessage::set_body_file(int fd, off_t size) {
+        if (_body_file_fd != -1)
+            close(_body_file_fd);
+        _body_file_fd = fd;
+        _body_file_size = size;
+    }
+
+    int ResponseMessage::release_body_file() {
+        int fd = _body_file_fd;
+        _body_file_fd = -1;
+        _body_file_size = 0;
+        return fd;
+    }
+
+    void ResponseMessage::add_body_range(const std::string& head, off_t start, off_t end) {
+        _body_ranges.push_back(BodyRange(head, start, end));
+    }
+
+    void ResponseMessage::set_body_buffer(const Utility::SharedBuffer& buffer) {
+        _body_buffer = buffer;
+    }
+
+    void ResponseMessage::set_cached_head(const Utility::SharedBuffer& head) {
+        _cached_head = head;
     }
 
-    void ResponseMessage::append_complete_response(const std::string& response_part) {
-        _complete_response +=  response_part;
+    void ResponseMessage::set_gzip_level(int level) {
+        _gzip_level = level;
+    }
+
+    // a body in memory is compressed right away, into _message_body, the body stays as it was on failure
+    bool ResponseMessage::compress_body(int level) {
+        Utility::Deflater deflater(level);
+        std::string compressed;
+        bool compressed_ok;
+        if (_body_buffer.empty())
+            compressed_ok = deflater.compress(_message_body.data(), _message_body.size(), compressed, true);
+        else
+            compressed_ok = deflater.compress(_body_buffer.data(), _body_buffer.size(), compressed, true);
+        if (!compressed_ok)
+            return false;
+        _body_buffer.reset();
+        _message_body.swap(compressed);
+        return true;
     }
 
 	void ResponseMessage::set_header_element(std::string header, std::string value) {
@@ -59,8 +161,44 @@ namespace HTTPResponse {
          return _message_body;
     }
 
-    std::string& ResponseMessage::get_complete_response() {
-        return _complete_response;
+    std::string& ResponseMessage::get_serialized_head() {
+        return _serialized_head;
+    }
+
+    int ResponseMessage::get_body_file_fd() const {
+        return _body_file_fd;
+    }
+
+    off_t ResponseMessage::get_body_file_size() const {
+        return _body_file_size;
+    }
+
+    const std::vector<BodyRange>& ResponseMessage::get_body_ranges() const {
+        return _body_ranges;
+    }
+
+    // what the Content-Length announces, wherever the body is
+    off_t ResponseMessage::get_body_length() const {
+        if (_body_file_fd == -1)
+            return _body_buffer.empty() ? _message_body.size() : _body_buffer.size();
+        if (_body_ranges.empty())
+            return _body_file_size;
+        off_t length = 0;
+        for (std::vector<BodyRange>::const_iterator it = _body_ranges.begin(); it != _body_ranges.end(); ++it)
+            length += it->head.size() + (it->end - it->start);
+        return length;
+    }
+
+    const Utility::SharedBuffer& ResponseMessage::get_body_buffer() const {
+        return _body_buffer;
+    }
+
+    const Utility::SharedBuffer& ResponseMessage::get_cached_head() const {
+        return _cached_head;
+    }
+
+    int ResponseMessage::get_gzip_level() const {
+        return _gzip_level;
     }
 
 	const std::map<std::string, std::string>& ResponseMessage::get_response_headers() const {
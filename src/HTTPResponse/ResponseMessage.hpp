@@ -2,8 +2,21 @@
 
 #include <string>
 #include <map>
+#include <vector>
+#include <sys/types.h> // for off_t
+
+#include "../Utility/SharedBuffer.hpp"
 
 namespace HTTPResponse {
+    // a part of a ranged body: what goes in front of it (a multipart delimiter and headers), then bytes [start, end) of the file
+    struct BodyRange {
+        BodyRange(const std::string& head, off_t start, off_t end) : head(head), start(start), end(end) {}
+
+        std::string head;
+        off_t start;
+        off_t end;
+    };
+
     class ResponseMessage {
 
     private:
@@ -11,7 +24,13 @@ namespace HTTPResponse {
         std::string _status_code;
         std::string _reason_phrase;
         std::string _message_body;
-        std::string _complete_response;
+        std::string _serialized_head; // status line and headers, sent in front of the body without being joined to it
+        Utility::SharedBuffer _cached_head; // status line and headers of a static file, _serialized_head then only holds the rest
+        int _body_file_fd; // a body sent straight from the file, -1 when the body is in _message_body
+        off_t _body_file_size;
+        std::vector<BodyRange> _body_ranges; // only these parts of the body file are sent when set
+        Utility::SharedBuffer _body_buffer; // a body from the content cache, sent without being copied
+        int _gzip_level; // the body file is compressed while it is sent, 0 when it goes out as it is
 		std::map<std::string, std::string> _response_headers;
 
     public:
@@ -19,18 +38,34 @@ namespace HTTPResponse {
         ResponseMessage(const ResponseMessage& other);
         ~ResponseMessage();
 
+        void reset();
+
         /* getters & setters */
         void set_status_code(const std::string& code);
         void set_reason_phrase(const std::string& reason);
 		void set_message_body(const std::string& body);
-        void set_complete_response(const std::string& response);
-        void append_complete_response(const std::string& response_part);
+        void swap_message_body(std::string& body);
+        void serialize_head(bool end_header_section);
+        void set_body_file(int fd, off_t size);
+        int release_body_file();
+        void add_body_range(const std::string& head, off_t start, off_t end);
+        void set_body_buffer(const Utility::SharedBuffer& buffer);
+        void set_cached_head(const Utility::SharedBuffer& head);
+        void set_gzip_level(int level);
+        bool compress_body(int level);
 		void set_header_element(std::string header, std::string value);
         const std::string& get_HTTP_version() const;
         const std::string& get_status_code() const;
         const std::string& get_reason_phrase() const;
         const std::string& get_message_body() const;
-        std::string& get_complete_response();
+        std::string& get_serialized_head();
+        int get_body_file_fd() const;
+        off_t get_body_file_size() const;
+        const std::vector<BodyRange>& get_body_ranges() const;
+        off_t get_body_length() const;
+        const Utility::SharedBuffer& get_body_buffer() const;
+        const Utility::SharedBuffer& get_cached_head() const;
+        int get_gzip_level() const;
 		const std::map<std::string, std::string>& get_response_headers() const;
     };
 }
@@ -3,7 +3,15 @@
 namespace HTTPResponse
 {
 
-    SpecifiedConfig::SpecifiedConfig() {
+    SpecifiedConfig::SpecifiedConfig()
+    : _autoindex(0)
+    , _static_precompressed(0)
+    , _gzip(0)
+    , _gzip_min_length(0)
+    , _gzip_comp_level(0)
+    , _client_max_body_size(0)
+    , _id(0)
+    {
     }
 
     SpecifiedConfig::SpecifiedConfig(const SpecifiedConfig &other) {
@@ -17,10 +25,17 @@ namespace HTTPResponse
 		_limit_except = other._limit_except;
 		_route = other._route;
 		_methods_line = other. _methods_line;
+		_upload_dir = other._upload_dir;
 		_autoindex = other._autoindex;
+		_static_precompressed = other._static_precompressed;
+		_gzip = other._gzip;
+		_gzip_types = other._gzip_types;
+		_gzip_min_length = other._gzip_min_length;
+		_gzip_comp_level = other._gzip_comp_level;
         _client_max_body_size = other._client_max_body_size;
         _cgi_extention_list = other._cgi_extention_list;
         _index_page = other._index_page;
+        _id = other._id;
         return *this;
     }
 
@@ -52,7 +67,7 @@ namespace HTTPResponse
             _cgi_extention_list.push_back(*it);
     }
 
-    void SpecifiedConfig::set_client_max_body_size(int client_max_body_size)
+    void SpecifiedConfig::set_client_max_body_size(long client_max_body_size)
     {
         _client_max_body_size = client_max_body_size;
     }
@@ -79,6 +94,26 @@ namespace HTTPResponse
 		_autoindex = autoindex;
     }
 
+    void SpecifiedConfig::set_static_precompressed(int static_precompressed) {
+		_static_precompressed = static_precompressed;
+    }
+
+    void SpecifiedConfig::set_gzip(int gzip) {
+		_gzip = gzip;
+    }
+
+    void SpecifiedConfig::set_gzip_types(const std::vector<std::string>& types) {
+		_gzip_types = types;
+    }
+
+    void SpecifiedConfig::set_gzip_min_length(int gzip_min_length) {
+		_gzip_min_length = gzip_min_length;
+    }
+
+    void SpecifiedConfig::set_gzip_comp_level(int gzip_comp_level) {
+		_gzip_comp_level = gzip_comp_level;
+    }
+
     void SpecifiedConfig::set_id(int num) {
         _id = num;
     }
@@ -88,7 +123,7 @@ namespace HTTPResponse
     }
     
     /* getters */
-    int SpecifiedConfig::get_client_max_body_size(void) const {
+    long SpecifiedConfig::get_client_max_body_size(void) const {
         return _client_max_body_size;
     }
 
@@ -108,6 +143,26 @@ namespace HTTPResponse
         return _autoindex;
     }
 
+	int SpecifiedConfig::get_static_precompressed(void) const {
+        return _static_precompressed;
+    }
+
+	int SpecifiedConfig::get_gzip(void) const {
+        return _gzip;
+    }
+
+	const std::vector<std::string>& SpecifiedConfig::get_gzip_types(void) const {
+        return _gzip_types;
+    }
+
+	int SpecifiedConfig::get_gzip_min_length(void) const {
+        return _gzip_min_length;
+    }
+
+	int SpecifiedConfig::get_gzip_comp_level(void) const {
+        return _gzip_comp_level;
+    }
+
 	const std::vector<std::string>& SpecifiedConfig::get_limit_except(void) const {
         return _limit_except;
     }
@@ -21,7 +21,12 @@ namespace HTTPResponse
 		std::vector<std::string> _limit_except;
 		std::vector<std::string> _cgi_extention_list;
 		int _autoindex;
-		int _client_max_body_size;
+		int _static_precompressed;
+		int _gzip;
+		std::vector<std::string> _gzip_types;
+		int _gzip_min_length;
+		int _gzip_comp_level;
+		long _client_max_body_size;
 		int _id;
 
 	public:
@@ -41,8 +46,13 @@ namespace HTTPResponse
 		void set_error_page_value(const std::map<int, std::string>& errors);
 		void set_limit_except(const std::vector<std::string>& methods);
 		void set_autoindex(int autoindex);
+		void set_static_precompressed(int static_precompressed);
+		void set_gzip(int gzip);
+		void set_gzip_types(const std::vector<std::string>& types);
+		void set_gzip_min_length(int gzip_min_length);
+		void set_gzip_comp_level(int gzip_comp_level);
 		void set_extention_list(const std::vector<std::string>& extentions);
-		void set_client_max_body_size(int client_max_body_size);
+		void set_client_max_body_size(long client_max_body_size);
 		void set_id(int num);
 	
 		const std::string& get_root(void) const;
@@ -55,7 +65,12 @@ namespace HTTPResponse
 		const std::vector<std::string>& get_limit_except(void) const;
 		const std::vector<std::string>& get_extention_list(void) const;
 		int get_autoindex(void) const;
-		int get_client_max_body_size(void) const;
+		int get_static_precompressed(void) const;
+		int get_gzip(void) const;
+		const std::vector<std::string>& get_gzip_types(void) const;
+		int get_gzip_min_length(void) const;
+		int get_gzip_comp_level(void) const;
+		long get_client_max_body_size(void) const;
 		int get_id(void) const;
 		
 	};
@@ -0,0 +1,142 @@
+#include "CharScan.hpp"
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+# include <immintrin.h>
+#endif
+
+namespace Utility {
+
+	namespace {
+		// tchar = "!" / "#" / "$" / "%" / "&" / "'" / "*" / "+" / "-" / "." / "^" / "_" / "`" / "|" / "~" / DIGIT / ALPHA
+		const unsigned char TOKEN_CHARS[256] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 1, 0, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1, 0,
+			1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+			0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+			1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1,
+			1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+			1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 0, 1, 0
+			// the upper half is 0
+		};
+
+		inline bool is_control(unsigned char character, char stop) {
+			return (character < 0x20 && character != '\t') || character == 0x7F || character == static_cast<unsigned char>(stop);
+		}
+
+#if defined(__SSE2__)
+		// shifted so that low lands on -128, one signed comparison then tells the bytes in [low, high]
+		inline __m128i in_range(__m128i bytes, int low, int high) {
+			__m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8(static_cast<char>(low - 128)));
+			return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(high - low + 1 - 128)));
+		}
+
+		// letters, digits and '-': what nearly every method and header name consists of
+		inline unsigned int common_token_mask(const char *data) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+			__m128i letters = in_range(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), 'a', 'z');
+			__m128i digits = in_range(bytes, '0', '9');
+			__m128i hyphens = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('-'));
+			return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letters, digits), hyphens));
+		}
+
+		inline unsigned int control_mask(const char *data, char stop) {
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+			__m128i controls = _mm_andnot_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t')), in_range(bytes, 0, 0x1F));
+			controls = _mm_or_si128(controls, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(0x7F)));
+			return _mm_movemask_epi8(_mm_or_si128(controls, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(stop))));
+		}
+#endif
+
+#if defined(__AVX2__)
+		inline __m256i in_range_32(__m256i bytes, int low, int high) {
+			__m256i shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8(static_cast<char>(low - 128)));
+			return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(high - low + 1 - 128)), shifted);
+		}
+
+		inline unsigned int common_token_mask_32(const char *data) {
+			__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+			__m256i letters = in_range_32(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), 'a', 'z');
+			__m256i digits = in_range_32(bytes, '0', '9');
+			__m256i hyphens = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('-'));
+			return static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(letters, digits), hyphens)));
+		}
+
+		inline unsigned int control_mask_32(const char *data, char stop) {
+			__m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+			__m256i controls = _mm256_andnot_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t')), in_range_32(bytes, 0, 0x1F));
+			controls = _mm256_or_si256(controls, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(0x7F)));
+			return static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_or_si256(controls, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(stop)))));
+		}
+#endif
+	}
+
+	// A block of common characters is skipped at once; a rarer token character like '_' or '.' is
+	// checked in the table and the scan goes on right behind it.
+	size_t find_non_token(const char *data, size_t size) {
+		size_t i = 0;
+#if defined(__AVX2__)
+		while (i + 32 <= size) {
+			unsigned int others = ~common_token_mask_32(data + i);
+			if (others == 0) {
+				i += 32;
+				continue;
+			}
+			i += __builtin_ctz(others);
+			if (!TOKEN_CHARS[static_cast<unsigned char>(data[i])]) {
+				return i;
+			}
+			i++;
+		}
+#endif
+#if defined(__SSE2__)
+		while (i + 16 <= size) {
+			unsigned int others = ~common_token_mask(data + i) & 0xFFFF;
+			if (others == 0) {
+				i += 16;
+				continue;
+			}
+			i += __builtin_ctz(others);
+			if (!TOKEN_CHARS[static_cast<unsigned char>(data[i])]) {
+				return i;
+			}
+			i++;
+		}
+#endif
+		for (; i < size; i++) {
+			if (!TOKEN_CHARS[static_cast<unsigned char>(data[i])]) {
+				return i;
+			}
+		}
+		return size;
+	}
+
+	size_t find_control_or(const char *data, size_t size, char stop) {
+		size_t i = 0;
+#if defined(__AVX2__)
+		for (; i + 32 <= size; i += 32) {
+			unsigned int found = control_mask_32(data + i, stop);
+			if (found != 0) {
+				return i + __builtin_ctz(found);
+			}
+		}
+#endif
+#if defined(__SSE2__)
+		for (; i + 16 <= size; i += 16) {
+			unsigned int found = control_mask(data + i, stop);
+			if (found != 0) {
+				return i + __builtin_ctz(found);
+			}
+		}
+#endif
+		for (; i < size; i++) {
+			if (is_control(static_cast<unsigned char>(data[i]), stop)) {
+				return i;
+			}
+		}
+		return size;
+	}
+}
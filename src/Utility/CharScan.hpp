@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Utility {
+
+	// Scanning kernels for the request parser. They look at 32 bytes at a time when built with AVX2,
+	// 16 with SSE2 (every x86-64 target) and one at a time otherwise; all of them return the position
+	// of the first byte that stops the scan, or size if there is none.
+
+	// first byte that is not a tchar (rfc 9110 5.6.2): the end of a method or of a header name
+	size_t find_non_token(const char *data, size_t size);
+	// first control character (HTAB aside) or occurrence of stop: the end of a request target, or an invalid byte in a header value
+	size_t find_control_or(const char *data, size_t size, char stop);
+}
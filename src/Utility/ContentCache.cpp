@@ -0,0 +1,123 @@
+#include "ContentCache.hpp"
+#include "../Constants.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace Utility {
+
+	pthread_mutex_t ContentCache::_mutex = PTHREAD_MUTEX_INITIALIZER;
+	ContentCache::EntryMap ContentCache::_entries;
+	std::list<std::string> ContentCache::_lru;
+	size_t ContentCache::_size = 0;
+	size_t ContentCache::_max_size = 0;
+	size_t ContentCache::_max_file_size = Constants::DEFAULT_CONTENT_CACHE_MAX_FILE;
+
+	// called before the servers start, lookups read the settings without locking
+	void ContentCache::configure(size_t max_size, size_t max_file_size) {
+		pthread_mutex_lock(&_mutex);
+		_max_size = max_size;
+		_max_file_size = max_file_size;
+		while (!_entries.empty() && _size > _max_size) {
+			_erase(_entries.find(_lru.back()));
+		}
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	// The content of the regular file at path if it is small enough to be cached, read from disk
+	// when it is not in the cache yet or changed since. info describes the file that was found.
+	bool ContentCache::find(const std::string &path, OpenFileCache::Info &info, SharedBuffer &content) {
+		if (_max_size == 0) {
+			return false;
+		}
+		info = OpenFileCache::lookup(path);
+		if (info.error != 0 || !S_ISREG(info.mode) || static_cast<size_t>(info.size) > _max_file_size) {
+			return false;
+		}
+		pthread_mutex_lock(&_mutex);
+		EntryMap::iterator it = _entries.find(path);
+		if (it != _entries.end() && it->second.mtime == info.mtime && it->second.content.size() == static_cast<size_t>(info.size)) {
+			_lru.splice(_lru.begin(), _lru, it->second.lru_position);
+			content = it->second.content;
+			pthread_mutex_unlock(&_mutex);
+			return true;
+		}
+		pthread_mutex_unlock(&_mutex);
+		if (!_read(path, info, content)) {
+			return false;
+		}
+		pthread_mutex_lock(&_mutex);
+		_insert(path, info, content);
+		pthread_mutex_unlock(&_mutex);
+		return true;
+	}
+
+	size_t ContentCache::size() {
+		pthread_mutex_lock(&_mutex);
+		size_t size = _size;
+		pthread_mutex_unlock(&_mutex);
+		return size;
+	}
+
+	size_t ContentCache::count() {
+		pthread_mutex_lock(&_mutex);
+		size_t count = _entries.size();
+		pthread_mutex_unlock(&_mutex);
+		return count;
+	}
+
+	// reads outside of the lock, the other threads keep serving from the cache meanwhile
+	bool ContentCache::_read(const std::string &path, OpenFileCache::Info &info, SharedBuffer &content) {
+		int fd = OpenFileCache::open(path, info);
+		if (fd == Constants::ERROR) {
+			return false;
+		}
+		if (static_cast<size_t>(info.size) > _max_file_size) {
+			close(fd);
+			return false;
+		}
+		std::string data(static_cast<size_t>(info.size), '\0');
+		size_t bytes_read = 0;
+		while (bytes_read < data.size()) {
+			ssize_t ret = pread(fd, &data[bytes_read], data.size() - bytes_read, bytes_read);
+			if (ret == Constants::ERROR && errno == EINTR) {
+				continue;
+			}
+			if (ret <= 0) { // failed, or the file got shorter since the fstat
+				close(fd);
+				return false;
+			}
+			bytes_read += ret;
+		}
+		close(fd);
+		content = SharedBuffer(data);
+		return true;
+	}
+
+	// the mutex is held
+	void ContentCache::_insert(const std::string &path, const OpenFileCache::Info &info, const SharedBuffer &content) {
+		EntryMap::iterator it = _entries.find(path);
+		if (it != _entries.end()) {
+			_erase(it);
+		}
+		if (content.size() > _max_size) {
+			return;
+		}
+		while (!_entries.empty() && _size + content.size() > _max_size) {
+			_erase(_entries.find(_lru.back()));
+		}
+		_lru.push_front(path);
+		Entry &entry = _entries[path];
+		entry.content = content;
+		entry.mtime = info.mtime;
+		entry.lru_position = _lru.begin();
+		_size += content.size();
+	}
+
+	void ContentCache::_erase(EntryMap::iterator it) {
+		_size -= it->second.content.size();
+		_lru.erase(it->second.lru_position);
+		_entries.erase(it);
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <list>
+#include <ctime>
+#include <cstddef>
+#include <sys/types.h> // for off_t
+#include <pthread.h>
+
+#include "SharedBuffer.hpp"
+#include "OpenFileCache.hpp"
+
+namespace Utility {
+
+	// The content of small static files, shared by every server of the process. Files up to
+	// max_file_size bytes are kept until the total goes over max_size, then the least recently
+	// used ones are dropped. A hit is checked against the mtime and size of the file on disk
+	// (as the open file cache sees it), a changed file is read again. Off while max_size is 0.
+	class ContentCache
+	{
+	public:
+		static void configure(size_t max_size, size_t max_file_size);
+		static bool find(const std::string &path, OpenFileCache::Info &info, SharedBuffer &content);
+		static size_t size();
+		static size_t count();
+
+	private:
+		struct Entry
+		{
+			SharedBuffer content;
+			time_t mtime;
+			std::list<std::string>::iterator lru_position;
+		};
+		typedef std::map<std::string, Entry> EntryMap;
+
+		static pthread_mutex_t _mutex;
+		static EntryMap _entries;
+		static std::list<std::string> _lru; // most recently used first
+		static size_t _size; // bytes held
+		static size_t _max_size;
+		static size_t _max_file_size;
+
+		ContentCache();
+
+		static bool _read(const std::string &path, OpenFileCache::Info &info, SharedBuffer &content);
+		static void _insert(const std::string &path, const OpenFileCache::Info &info, const SharedBuffer &content);
+		static void _erase(EntryMap::iterator it);
+	};
+}
@@ -0,0 +1,50 @@
+#include "Deflater.hpp"
+
+#include <cstring> // for memset
+
+namespace Utility {
+
+	Deflater::Deflater(int level)
+	: _initialized(false)
+	, _finished(false)
+	{
+		std::memset(&_stream, 0, sizeof(_stream));
+		// 16 on top of the window bits asks zlib for a gzip header and trailer instead of the zlib ones
+		_initialized = deflateInit2(&_stream, level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+	}
+
+	Deflater::~Deflater() {
+		if (_initialized) {
+			deflateEnd(&_stream);
+		}
+	}
+
+	// false when zlib could not set up the stream or gave up on it, out then holds a broken stream
+	bool Deflater::compress(const char *data, size_t size, std::string &out, bool finish) {
+		if (!_initialized || _finished) {
+			return false;
+		}
+		_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+		_stream.avail_in = static_cast<uInt>(size);
+		int flush = finish ? Z_FINISH : Z_NO_FLUSH;
+		int result;
+		do {
+			size_t used = out.size();
+			size_t room = deflateBound(&_stream, _stream.avail_in) + 64; // one round is enough most of the time
+			out.resize(used + room);
+			_stream.next_out = reinterpret_cast<Bytef *>(&out[used]);
+			_stream.avail_out = static_cast<uInt>(room);
+			result = deflate(&_stream, flush);
+			out.resize(used + room - _stream.avail_out);
+			if (result == Z_STREAM_ERROR) {
+				return false;
+			}
+		} while (_stream.avail_out == 0 || (finish && result != Z_STREAM_END));
+		_finished = result == Z_STREAM_END;
+		return true;
+	}
+
+	bool Deflater::is_finished() const {
+		return _finished;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <zlib.h>
+
+namespace Utility {
+
+	// A gzip stream fed piece by piece: every call compresses the next part of the body and appends
+	// whatever zlib has ready to out, the call with finish set closes the stream with its trailer.
+	// A body that is in memory already is compressed in one call.
+	class Deflater
+	{
+	public:
+		explicit Deflater(int level);
+		~Deflater();
+
+		bool compress(const char *data, size_t size, std::string &out, bool finish);
+		bool is_finished() const;
+
+	private:
+		z_stream _stream;
+		bool _initialized;
+		bool _finished;
+
+		Deflater(const Deflater &other);
+		Deflater &operator=(const Deflater &other);
+	};
+}
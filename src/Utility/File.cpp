@@ -8,13 +8,14 @@
 #include <unistd.h>
 #include <errno.h>
 #include <string.h> //for strerror
+#include <sstream> // for the entity tag
 
 //stat path check: relative to the current working directory of the calling process
 namespace Utility
 {
 	MimeTypes File::_mimes;
 
-	File::File() { }
+	File::File() : _has_path_info(false) { }
 
 	File::~File() { }
 
@@ -44,21 +45,26 @@ namespace Utility
 		_root = root;
 	}
 
+	// exists, is_regular and is_directory share one lookup of the path
+	const OpenFileCache::Info &File::_get_path_info(void) {
+		if (!_has_path_info || _path_info_path != _path) {
+			_path_info = OpenFileCache::lookup(_path);
+			_path_info_path = _path;
+			_has_path_info = true;
+		}
+		return _path_info;
+	}
+
 	bool File::exists(void) {
-		struct stat buffer;
-		return  stat(_path.c_str(), &buffer) == 0;
+		return _get_path_info().error == 0;
 	}
 
 	bool File::is_regular(void) {
-		struct stat buffer;
-		stat(_path.c_str(), &buffer);
-		return S_ISREG(buffer.st_mode);
+		return S_ISREG(_get_path_info().mode);
 	}
 
 	bool File::is_directory(void) {
-		struct stat buffer;
-		stat(_path.c_str(), &buffer);
-		return S_ISDIR(buffer.st_mode);
+		return S_ISDIR(_get_path_info().mode);
 	}
 
 	const std::string & File::list_directory(void) {
@@ -86,23 +92,10 @@ namespace Utility
 	}
 
 	bool File::find_index_page(const std::string& index) {
-		DIR *dir_p;
-		struct dirent *entry;
-
-		dir_p = opendir(_path.c_str());
-		if (!dir_p) {
-			// Utility::logger("DEBUG mkdir : " + std::string(strerror(errno)), RED);
+		if (index.empty() || OpenFileCache::lookup(_path + "/" + index).error != 0)
 			return false;
-		}
-		while ((entry = readdir(dir_p))) {
-			if (entry->d_name == index) {
-				_index_page = std::string(entry->d_name);
-				closedir(dir_p);
-				return true;
-			}
-		}
-		closedir(dir_p);
-		return false;
+		_index_page = index;
+		return true;
 	}
 
 	std::string File::get_content(const std::string &str) {
@@ -128,11 +121,17 @@ namespace Utility
 		return file_content;
 	}
 
+	// the fd of a regular file whose content is sent as it is, -1 if it can't be read
+	int File::open_regular_file(const std::string &str, OpenFileCache::Info &info) {
+		return OpenFileCache::open(str, info);
+	}
+
 	bool File::un_link(const std::string &str) {
 		if (unlink(str.c_str()) == Constants::ERROR) {
 			// Utility::logger("DEBUG unlink : " + std::string(strerror(errno)), RED);
 			return false;
 		}
+		OpenFileCache::invalidate(str);
 		return true;
 	}
 
@@ -144,6 +143,7 @@ namespace Utility
 			// Utility::logger("DEBUG mkdir : " + std::string(strerror(errno)), RED);
 			return false;
 		}
+		OpenFileCache::invalidate(_path);
 		return true;
 	}
 
@@ -155,35 +155,49 @@ namespace Utility
 			// Utility::logger("DEBUG mkdir : " + std::string(strerror(errno)), RED);
 			return false;
 		}
+		OpenFileCache::invalidate(str);
 		return true;
 	}
 
 	std::string File::last_modified_info() {
-		struct stat statbuf;
-		struct tm	*time;
-		char buf[32];
-
-		int ret = stat(_path.c_str(), &statbuf);
-		if (ret != 0)
+		if (!exists())
 			return "";
-		time = gmtime(&statbuf.st_mtime);
-		strftime(buf, 32, "%a, %d %b %Y %T GMT", time);
-		std::string ret_val(buf);
-		return ret_val;
+		return http_date(_get_path_info().mtime);
 	}
 
 	std::string File::last_modified_info(const std::string &path) {
-		struct stat statbuf;
-		struct tm	*time;
+		OpenFileCache::Info info = OpenFileCache::lookup(path);
+		if (info.error != 0)
+			return "";
+		return http_date(info.mtime);
+	}
+
+	std::string File::http_date(time_t time) {
+		struct tm	tm;
 		char buf[32];
 
-		int ret = stat(path.c_str(), &statbuf);
-		if (ret != 0)
-			return "";
-		time = gmtime(&statbuf.st_mtime);
-		strftime(buf, 32, "%a, %d %b %Y %T GMT", time);
-		std::string ret_val(buf);
-		return ret_val;
+		gmtime_r(&time, &tm);
+		strftime(buf, 32, "%a, %d %b %Y %T GMT", &tm);
+		return std::string(buf);
+	}
+
+	// the IMF-fixdate format that http_date writes, which is what clients send back
+	bool File::parse_http_date(const std::string &str, time_t &time) {
+		struct tm	tm;
+
+		memset(&tm, 0, sizeof(tm));
+		const char *end = strptime(str.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+		if (end == NULL || *end != '\0')
+			return false;
+		time = timegm(&tm);
+		return true;
+	}
+
+	// same format as nginx: the mtime and the size in hex
+	std::string File::entity_tag(time_t mtime, off_t size) {
+		std::ostringstream tag;
+		tag << '"' << std::hex << mtime << '-' << size << '"';
+		return tag.str();
 	}
 
 	std::string File::get_mime_type(const std::string& str) {
@@ -2,8 +2,10 @@
 
 #include <iostream>
 #include <vector>
+#include <sys/types.h> // for off_t
 
 #include "MimeTypes.hpp"
+#include "OpenFileCache.hpp"
 
 namespace Utility
 {
@@ -15,8 +17,13 @@ namespace Utility
 		std::string _target;
 		std::string _dir;
 		std::string _index_page;
+		OpenFileCache::Info _path_info; // of _path, looked up once per request
+		std::string _path_info_path;
+		bool _has_path_info;
 		static MimeTypes _mimes;
 
+		const OpenFileCache::Info &_get_path_info(void);
+
 	public:
 		File(/* args */);
 		~File();
@@ -30,6 +37,7 @@ namespace Utility
 		const std::string& get_target(void);
 		const std::string& get_index_page(void);
 		std::string get_content(const std::string &str);
+		int open_regular_file(const std::string &str, OpenFileCache::Info &info);
 		bool exists(void);
 		bool is_regular(void);
 		bool is_directory(void);
@@ -40,6 +48,9 @@ namespace Utility
 		bool create_dir(const std::string &str);
 		std::string last_modified_info(const std::string &path);
 		std::string last_modified_info();
+		static std::string http_date(time_t time);
+		static std::string entity_tag(time_t mtime, off_t size);
+		static bool parse_http_date(const std::string &str, time_t &time);
 		std::string get_mime_type(const std::string& str);
 		std::string get_extension(const std::string& str);
 		std::string extract_file_name(const std::string &str);
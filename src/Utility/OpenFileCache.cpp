@@ -0,0 +1,144 @@
+#include "OpenFileCache.hpp"
+#include "TimerWheel.hpp"
+#include "../Constants.hpp"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace Utility {
+
+	OpenFileCache::Info::Info()
+	: error(0)
+	, mode(0)
+	, size(0)
+	, mtime(0)
+	{}
+
+	pthread_mutex_t OpenFileCache::_mutex = PTHREAD_MUTEX_INITIALIZER;
+	OpenFileCache::EntryMap OpenFileCache::_entries;
+	std::list<std::string> OpenFileCache::_lru;
+	size_t OpenFileCache::_max_entries = 0;
+	int OpenFileCache::_valid = Constants::DEFAULT_OPEN_FILE_CACHE_VALID;
+
+	// called before the servers start, lookups read the settings without locking
+	void OpenFileCache::configure(size_t max_entries, int valid) {
+		pthread_mutex_lock(&_mutex);
+		_max_entries = max_entries;
+		_valid = valid;
+		while (_entries.size() > _max_entries) {
+			_erase(_entries.find(_lru.back()));
+		}
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	OpenFileCache::Info OpenFileCache::lookup(const std::string &path) {
+		if (_max_entries == 0) {
+			return _query(path, NULL);
+		}
+		pthread_mutex_lock(&_mutex);
+		Info info = _find(path).info;
+		pthread_mutex_unlock(&_mutex);
+		return info;
+	}
+
+	// An fd of the regular file at path that the caller owns, -1 if there is none. A cached file
+	// costs one dup, sendfile takes explicit offsets so the copies don't get in each other's way.
+	int OpenFileCache::open(const std::string &path, Info &info) {
+		if (_max_entries == 0) {
+			int fd;
+			info = _query(path, &fd);
+			return fd;
+		}
+		pthread_mutex_lock(&_mutex);
+		Entry &entry = _find(path);
+		info = entry.info;
+		int fd = Constants::ERROR;
+		if (entry.fd != Constants::ERROR) {
+			fd = fcntl(entry.fd, F_DUPFD_CLOEXEC, 0);
+		}
+		pthread_mutex_unlock(&_mutex);
+		return fd;
+	}
+
+	// for the changes the server makes itself, they show up right away instead of after valid seconds
+	void OpenFileCache::invalidate(const std::string &path) {
+		if (_max_entries == 0) {
+			return;
+		}
+		pthread_mutex_lock(&_mutex);
+		EntryMap::iterator it = _entries.find(path);
+		if (it != _entries.end()) {
+			_erase(it);
+		}
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	size_t OpenFileCache::size() {
+		pthread_mutex_lock(&_mutex);
+		size_t size = _entries.size();
+		pthread_mutex_unlock(&_mutex);
+		return size;
+	}
+
+	// stat, or with fd given, open and fstat so that the fd and the info belong to the same file
+	OpenFileCache::Info OpenFileCache::_query(const std::string &path, int *fd) {
+		Info info;
+		struct stat statbuf;
+
+		if (fd != NULL) {
+			*fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK); // a fifo must not block the server
+			if (*fd != Constants::ERROR) {
+				if (fstat(*fd, &statbuf) == 0 && S_ISREG(statbuf.st_mode)) {
+					fcntl(*fd, F_SETFD, FD_CLOEXEC); // CGI children must not inherit it
+					info.mode = statbuf.st_mode;
+					info.size = statbuf.st_size;
+					info.mtime = statbuf.st_mtime;
+					return info;
+				}
+				close(*fd);
+				*fd = Constants::ERROR;
+			}
+		}
+		if (stat(path.c_str(), &statbuf) == Constants::ERROR) {
+			info.error = errno;
+			return info;
+		}
+		info.mode = statbuf.st_mode;
+		info.size = statbuf.st_size;
+		info.mtime = statbuf.st_mtime;
+		return info;
+	}
+
+	// the entry of path, looked up again once it is older than valid seconds; the mutex is held
+	OpenFileCache::Entry &OpenFileCache::_find(const std::string &path) {
+		time_t now = TimerWheel::now();
+		EntryMap::iterator it = _entries.find(path);
+		if (it != _entries.end()) {
+			if (now - it->second.validated < _valid) {
+				_lru.splice(_lru.begin(), _lru, it->second.lru_position);
+				return it->second;
+			}
+			_erase(it);
+		}
+		Entry entry;
+		entry.info = _query(path, &entry.fd);
+		entry.validated = now;
+		_lru.push_front(path);
+		entry.lru_position = _lru.begin();
+		it = _entries.insert(std::make_pair(path, entry)).first;
+		if (_entries.size() > _max_entries) {
+			_erase(_entries.find(_lru.back()));
+		}
+		return it->second;
+	}
+
+	void OpenFileCache::_erase(EntryMap::iterator it) {
+		if (it->second.fd != Constants::ERROR) {
+			close(it->second.fd);
+		}
+		_lru.erase(it->second.lru_position);
+		_entries.erase(it);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <list>
+#include <ctime>
+#include <cstddef>
+#include <sys/types.h> // for off_t, mode_t
+#include <pthread.h>
+
+namespace Utility {
+
+	// What stat and open found out about recently served paths, shared by every server of the process:
+	// the type, size and mtime, an open fd for regular files, and failures like ENOENT as well. An entry
+	// is trusted for valid seconds, beyond max_entries the least recently used one is dropped.
+	// The cache is off while max_entries is 0, then every lookup goes to the filesystem.
+	class OpenFileCache
+	{
+	public:
+		struct Info
+		{
+			Info();
+
+			int error; // errno of the failed lookup, 0 when the path exists
+			mode_t mode;
+			off_t size;
+			time_t mtime;
+		};
+
+		static void configure(size_t max_entries, int valid);
+		static Info lookup(const std::string &path);
+		static int open(const std::string &path, Info &info);
+		static void invalidate(const std::string &path);
+		static size_t size();
+
+	private:
+		struct Entry
+		{
+			Info info;
+			int fd; // -1 unless the path is a regular file that could be opened
+			time_t validated;
+			std::list<std::string>::iterator lru_position;
+		};
+		typedef std::map<std::string, Entry> EntryMap;
+
+		static pthread_mutex_t _mutex;
+		static EntryMap _entries;
+		static std::list<std::string> _lru; // most recently used first
+		static size_t _max_entries;
+		static int _valid;
+
+		OpenFileCache();
+
+		static Info _query(const std::string &path, int *fd);
+		static Entry &_find(const std::string &path);
+		static void _erase(EntryMap::iterator it);
+	};
+}
@@ -0,0 +1,57 @@
+#include "SharedBuffer.hpp"
+
+namespace Utility {
+
+	SharedBuffer::SharedBuffer()
+	: _block(NULL)
+	{}
+
+	// takes the content of data, leaving it empty
+	SharedBuffer::SharedBuffer(std::string &data)
+	: _block(new Block())
+	{
+		_block->references = 1;
+		_block->data.swap(data);
+	}
+
+	SharedBuffer::SharedBuffer(const SharedBuffer &other)
+	: _block(other._block)
+	{
+		if (_block != NULL) {
+			__sync_add_and_fetch(&_block->references, 1);
+		}
+	}
+
+	SharedBuffer &SharedBuffer::operator=(const SharedBuffer &other) {
+		if (_block != other._block) {
+			SharedBuffer copy(other);
+			reset();
+			_block = copy._block;
+			copy._block = NULL;
+		}
+		return *this;
+	}
+
+	SharedBuffer::~SharedBuffer() {
+		reset();
+	}
+
+	const char *SharedBuffer::data() const {
+		return _block == NULL ? NULL : _block->data.data();
+	}
+
+	size_t SharedBuffer::size() const {
+		return _block == NULL ? 0 : _block->data.size();
+	}
+
+	bool SharedBuffer::empty() const {
+		return size() == 0;
+	}
+
+	void SharedBuffer::reset() {
+		if (_block != NULL && __sync_sub_and_fetch(&_block->references, 1) == 0) {
+			delete _block;
+		}
+		_block = NULL;
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace Utility {
+
+	// Bytes that never change once created, shared by reference count instead of being copied:
+	// the content cache and every response sending them hold the same block. Copies may live
+	// in different threads, the count is updated atomically.
+	class SharedBuffer
+	{
+	public:
+		SharedBuffer();
+		explicit SharedBuffer(std::string &data);
+		SharedBuffer(const SharedBuffer &other);
+		SharedBuffer &operator=(const SharedBuffer &other);
+		~SharedBuffer();
+
+		const char *data() const;
+		size_t size() const;
+		bool empty() const;
+		void reset();
+
+	private:
+		struct Block
+		{
+			int references;
+			std::string data;
+		};
+
+		Block *_block;
+	};
+}
@@ -20,5 +20,10 @@ namespace Utility {
 		T* operator-> () {
 			return _data;
 		}
+
+		void reset(T* value) {
+			delete _data;
+			_data = value;
+		}
 	};
 }
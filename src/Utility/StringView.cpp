@@ -0,0 +1,59 @@
+#include "StringView.hpp"
+
+#include <cstring> // for memchr, memcmp, strchr, strlen
+
+namespace Utility {
+
+	size_t StringView::find(char character, size_t from) const {
+		if (from >= _size) {
+			return npos;
+		}
+		const void *match = std::memchr(_data + from, character, _size - from);
+		return match == NULL ? npos : static_cast<const char *>(match) - _data;
+	}
+
+	size_t StringView::find_first_of(const char *characters, size_t from) const {
+		for (size_t i = from; i < _size; i++) {
+			if (_data[i] != '\0' && std::strchr(characters, _data[i]) != NULL) {
+				return i;
+			}
+		}
+		return npos;
+	}
+
+	StringView StringView::substr(size_t position, size_t length) const {
+		if (position > _size) {
+			position = _size;
+		}
+		if (length > _size - position) {
+			length = _size - position;
+		}
+		return StringView(_data + position, length);
+	}
+
+	// without the spaces and tabs around it, the optional whitespace of HTTP
+	StringView StringView::trim() const {
+		size_t start = 0;
+		size_t end = _size;
+		while (start < end && (_data[start] == ' ' || _data[start] == '\t')) {
+			start++;
+		}
+		while (end > start && (_data[end - 1] == ' ' || _data[end - 1] == '\t')) {
+			end--;
+		}
+		return StringView(_data + start, end - start);
+	}
+
+	bool StringView::equals(const char *str) const {
+		size_t length = std::strlen(str);
+		return length == _size && (_size == 0 || std::memcmp(_data, str, length) == 0);
+	}
+
+	bool StringView::equals(const std::string &str) const {
+		return str.size() == _size && (_size == 0 || std::memcmp(_data, str.data(), _size) == 0);
+	}
+
+	std::string StringView::str() const {
+		return std::string(_data, _size);
+	}
+}
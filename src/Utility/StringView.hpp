@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace Utility {
+
+	// A (pointer, length) view into bytes owned by someone else, e.g. the receive buffer of a connection.
+	// It must not outlive them: str() copies what has to stay.
+	class StringView
+	{
+	public:
+		static const size_t npos = static_cast<size_t>(-1);
+
+		StringView() : _data(NULL), _size(0) {}
+		StringView(const char *data, size_t size) : _data(data), _size(size) {}
+
+		const char *data() const { return _data; }
+		size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+		char operator[](size_t position) const { return _data[position]; }
+
+		size_t find(char character, size_t from = 0) const;
+		size_t find_first_of(const char *characters, size_t from = 0) const;
+		StringView substr(size_t position, size_t length = npos) const;
+		StringView trim() const;
+		bool equals(const char *str) const;
+		bool equals(const std::string &str) const;
+		std::string str() const;
+
+	private:
+		const char *_data;
+		size_t _size;
+	};
+}
@@ -0,0 +1,136 @@
+#include "TimerWheel.hpp"
+
+#include <time.h> // for clock_gettime
+
+namespace Utility {
+
+	TimerWheel::Timer::Timer()
+	: id(-1)
+	, expiry(0)
+	, prev(NULL)
+	, next(NULL)
+	{}
+
+	bool TimerWheel::Timer::is_scheduled() const {
+		return next != NULL;
+	}
+
+	TimerWheel::TimerWheel(time_t start)
+	: _current(start)
+	, _size(0)
+	{
+		for (int level = 0; level < LEVELS; level++) {
+			for (int slot = 0; slot < SLOTS; slot++) {
+				_slots[level][slot].prev = &_slots[level][slot];
+				_slots[level][slot].next = &_slots[level][slot];
+			}
+		}
+	}
+
+	TimerWheel::~TimerWheel() {}
+
+	// monotonic, so that changing the clock of the machine does not expire or freeze every timer
+	time_t TimerWheel::now() {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ts.tv_sec;
+	}
+
+	void TimerWheel::schedule(Timer &timer, time_t expiry) {
+		cancel(timer);
+		if (expiry <= _current) { // the current second has already been processed
+			expiry = _current + 1;
+		}
+		timer.expiry = expiry;
+		_insert(timer);
+		_size++;
+	}
+
+	void TimerWheel::cancel(Timer &timer) {
+		if (!timer.is_scheduled()) {
+			return;
+		}
+		timer.prev->next = timer.next;
+		timer.next->prev = timer.prev;
+		timer.prev = NULL;
+		timer.next = NULL;
+		_size--;
+	}
+
+	// Moves the wheel to now and hands out every timer that expired on the way.
+	void TimerWheel::advance(time_t now, std::vector<Timer *> &expired) {
+		if (_size == 0) {
+			if (now > _current) {
+				_current = now;
+			}
+			return;
+		}
+		while (_current < now) {
+			_current++;
+			// a level moves down once all the levels below it went around
+			for (int level = 1; level < LEVELS; level++) {
+				if (_current & ((static_cast<time_t>(1) << (SLOT_BITS * level)) - 1)) {
+					break;
+				}
+				_cascade(level);
+			}
+			Timer &head = _slots[0][_current & (SLOTS - 1)];
+			while (head.next != &head) {
+				Timer *timer = head.next;
+				cancel(*timer);
+				expired.push_back(timer);
+			}
+		}
+	}
+
+	// Seconds until the next timer expires or a higher level moves down, -1 when nothing is scheduled.
+	int TimerWheel::next_timeout() const {
+		if (_size == 0) {
+			return -1;
+		}
+		for (int i = 1; i < SLOTS; i++) {
+			time_t tick = _current + i;
+			const Timer &head = _slots[0][tick & (SLOTS - 1)];
+			if (head.next != &head || (tick & (SLOTS - 1)) == 0) {
+				return i;
+			}
+		}
+		return SLOTS;
+	}
+
+	size_t TimerWheel::size() const {
+		return _size;
+	}
+
+	void TimerWheel::_insert(Timer &timer) {
+		time_t delta = timer.expiry - _current;
+		time_t slot_time = timer.expiry;
+		time_t max_delta = (static_cast<time_t>(1) << (SLOT_BITS * LEVELS)) - 1;
+		if (delta > max_delta) { // beyond the span of the wheel, parked in its farthest slot until then
+			delta = max_delta;
+			slot_time = _current + max_delta;
+		}
+		int level = 0;
+		while (level < LEVELS - 1 && delta >= (static_cast<time_t>(1) << (SLOT_BITS * (level + 1)))) {
+			level++;
+		}
+		Timer &head = _slots[level][(slot_time >> (SLOT_BITS * level)) & (SLOTS - 1)];
+		timer.prev = head.prev;
+		timer.next = &head;
+		head.prev->next = &timer;
+		head.prev = &timer;
+	}
+
+	// reinserts the timers of the slot of the current second, they land in lower levels
+	void TimerWheel::_cascade(int level) {
+		Timer &head = _slots[level][(_current >> (SLOT_BITS * level)) & (SLOTS - 1)];
+		Timer *timer = head.next;
+		head.prev = &head;
+		head.next = &head;
+		while (timer != &head) {
+			Timer *next = timer->next;
+			_insert(*timer);
+			timer = next;
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <ctime>
+#include <vector>
+#include <cstddef>
+
+namespace Utility {
+
+	// Hierarchical timer wheel with a resolution of one second. Every level has SLOTS slots and
+	// covers SLOTS times the span of the level below it; a timer sits in the lowest level that can
+	// hold it and moves down when its slot comes up. Timers are intrusive list nodes, so scheduling,
+	// rescheduling and cancelling are O(1), and advancing costs one slot per elapsed second.
+	class TimerWheel
+	{
+	public:
+		struct Timer
+		{
+			Timer();
+
+			int id; // tells the owner of an expired timer
+			time_t expiry;
+			Timer *prev;
+			Timer *next;
+
+			bool is_scheduled() const;
+		};
+
+		explicit TimerWheel(time_t start);
+		~TimerWheel();
+
+		static time_t now();
+
+		void schedule(Timer &timer, time_t expiry);
+		void cancel(Timer &timer);
+		void advance(time_t now, std::vector<Timer *> &expired);
+		int next_timeout() const;
+		size_t size() const;
+
+	private:
+		static const int SLOT_BITS = 6;
+		static const int SLOTS = 1 << SLOT_BITS;
+		static const int LEVELS = 4;
+
+		Timer _slots[LEVELS][SLOTS]; // list heads
+		time_t _current; // the last second that has been processed
+		size_t _size;
+
+		TimerWheel(const TimerWheel &other);
+		TimerWheel &operator=(const TimerWheel &other);
+
+		void _insert(Timer &timer);
+		void _cascade(int level);
+	};
+}
@@ -7,13 +7,6 @@
 namespace Utility
 {
 
-    bool contains_whitespace(std::string &str)
-    {
-        size_t whitespace_found = str.find(' ', 0);
-        size_t tab_found = str.find('\t', 0);
-        return whitespace_found != std::string::npos || tab_found != std::string::npos;
-    }
-
     std::vector<std::string> _split_line(const std::string &line, const char delimiter)
     {
         size_t start = 0;
@@ -145,44 +138,39 @@ namespace Utility
 		return stringified_code;
 	}
 
+	// file sizes do not fit in an int
+	const std::string size_to_string(const off_t size) {
+		std::stringstream sstream;
+		sstream << size;
+		return sstream.str();
+	}
+
 	std::string get_formatted_date() {
 		struct timeval tv;
 		char buf[32];
-		struct tm *time;
+		struct tm time;
 
 		gettimeofday(&tv, NULL);
-		time = gmtime(&tv.tv_sec);
-		strftime(buf, 32, "%a, %d %b %Y %T GMT", time);
+		gmtime_r(&tv.tv_sec, &time); // the reentrant version, worker threads format dates concurrently
+		strftime(buf, 32, "%a, %d %b %Y %T GMT", &time);
 		std::string ret_val(buf);
 		return ret_val;
 	}
 
-    std::string get_number_in_string(std::string& line) {
-        if (line == "") {
-            return "";
-        }
-        size_t non_number_position = line.find_first_not_of("0123456789ABCDEF", 0);
-        if (non_number_position != std::string::npos) {
-            return line.substr(0, non_number_position);
-        }
-        else {
-            return line.substr(0, line.size());
-        }
-    }
-
     void logger(std::string str, std::string color)
 	{
-		struct tm *tm;
+		struct tm tm;
 		time_t rawtime;
 		char buf[32];
 
 		time(&rawtime);
-		tm = localtime(&rawtime);
-		int ret = strftime(buf, 32, "%T", tm);
+		localtime_r(&rawtime, &tm);
+		int ret = strftime(buf, 32, "%T", &tm);
 		buf[ret] = '\0';
 		(void)color;
-		std::cout << GREEN << "[" << buf << "] " << RESET;
-		std::cout << color << str << RESET << std::endl;
+		// one write per line so that the lines of the worker threads do not interleave
+		std::string line = std::string(GREEN) + "[" + buf + "] " + RESET + color + str + RESET + "\n";
+		std::cout << line << std::flush;
 	}
 
     bool is_found(const std::string& haystack, const std::string& needle) {
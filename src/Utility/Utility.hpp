@@ -3,13 +3,13 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <sys/types.h> // for off_t
 
 namespace Utility {
 
 	std::vector<std::string> _split_line(const std::string& line, const char delimiter);
 	std::vector<std::string> _split_line_in_two(const std::string& line, const char delimiter);
 	std::string _trim(const std::string& s);
-	bool contains_whitespace(std::string &str);
 	bool check_first_keyword(std::string line, std::string keyword);
 	bool check_after_keyword(size_t last_pos, std::string str);
 	void remove_white_space(std::string &line);
@@ -21,8 +21,8 @@ namespace Utility {
 	std::vector<std::string> split_string_by_white_space(const std::string& str);
 	bool is_hyphen(char c);
 	const std::string to_string(const int code);
+	const std::string size_to_string(const off_t size);
 	std::string get_formatted_date();
-	std::string get_number_in_string(std::string &line);
 	void logger(std::string str, std::string color);
 	bool is_found(const std::string& haystack, const std::string& needle);
 }
@@ -1,11 +1,143 @@
 #include "Webserver.hpp"
 #include "./Utility/Utility.hpp"
+#include "./Utility/OpenFileCache.hpp"
+#include "./Utility/ContentCache.hpp"
 #include "Constants.hpp"
+#include <pthread.h>
+#include <cstring> // for strerror
+#include <cstdio> // for perror
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <vector>
+#include <map>
+#include <unistd.h> // for fork
+#include <sys/wait.h> // for waitpid
 
 Webserver::Webserver(std::string file_path): _file_path(file_path) {}
 
 Webserver::~Webserver() {}
 
+// Every worker thread runs a complete server: its own event loop, listening sockets,
+// connections and timers. The config is only read once the threads are started.
+static void *run_server_thread(void *config)
+{
+	try
+	{
+		HTTP::Server server(static_cast<Config::ConfigData *>(config));
+		server.run();
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << '\n';
+		std::exit(EXIT_FAILURE); // a dead loop would silently stop serving its share of the connections
+	}
+	return NULL;
+}
+
+void Webserver::_run_worker_threads(Config::ConfigData *config)
+{
+	std::vector<pthread_t> threads;
+	for (int i = 0; i < config->get_worker_threads(); i++)
+	{
+		pthread_t thread;
+		int ret = pthread_create(&thread, NULL, run_server_thread, config);
+		if (ret != 0)
+		{
+			Utility::logger("Failed to start worker thread: " + std::string(strerror(ret)), RED);
+			std::exit(EXIT_FAILURE);
+		}
+		threads.push_back(thread);
+	}
+	Utility::logger("Started " + Utility::to_string(config->get_worker_threads()) + " worker threads", MAGENTA);
+	for (size_t i = 0; i < threads.size(); i++)
+		pthread_join(threads[i], NULL);
+}
+
+static volatile sig_atomic_t g_master_stop_signal = 0;
+
+static void stop_master(int signum)
+{
+	g_master_stop_signal = signum;
+}
+
+// The worker inherits the listening sockets of the master and creates its own event loop.
+static pid_t fork_worker_process(HTTP::Server &server)
+{
+	pid_t pid = fork();
+	if (pid == Constants::ERROR)
+	{
+		std::perror("fork worker process");
+		return pid;
+	}
+	if (pid == 0)
+	{
+		std::signal(SIGINT, SIG_DFL);
+		std::signal(SIGTERM, SIG_DFL);
+		try
+		{
+			server.run();
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << e.what() << '\n';
+		}
+		std::exit(EXIT_FAILURE); // run() only comes back on failure
+	}
+	Utility::logger("Worker process " + Utility::to_string(pid) + " started", MAGENTA);
+	return pid;
+}
+
+// The master binds the sockets, keeps worker_processes workers alive and only waits for them,
+// so a crashing worker takes down its own connections and not the ones of the others.
+void Webserver::_run_worker_processes(Config::ConfigData *config)
+{
+	HTTP::Server server(config);
+	server.setup_listeners();
+
+	struct sigaction action;
+	std::memset(&action, 0, sizeof(action));
+	action.sa_handler = stop_master; // no SA_RESTART: waitpid has to be interrupted
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	std::map<pid_t, time_t> workers; // pid -> start time
+	while (!g_master_stop_signal)
+	{
+		while (static_cast<int>(workers.size()) < config->get_worker_processes())
+		{
+			pid_t pid = fork_worker_process(server);
+			if (pid == Constants::ERROR)
+				break;
+			workers[pid] = std::time(0);
+		}
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid == Constants::ERROR)
+		{
+			if (errno == ECHILD) // every fork failed, try again later
+				sleep(1);
+			continue;
+		}
+		std::map<pid_t, time_t>::iterator worker = workers.find(pid);
+		if (worker == workers.end())
+			continue;
+		if (WIFSIGNALED(status))
+			Utility::logger("Worker process " + Utility::to_string(pid) + " killed by signal " + Utility::to_string(WTERMSIG(status)), RED);
+		else
+			Utility::logger("Worker process " + Utility::to_string(pid) + " exited with status " + Utility::to_string(WEXITSTATUS(status)), RED);
+		if (std::time(0) - worker->second < 1) // dies right away, do not spin on fork
+			sleep(1);
+		workers.erase(worker);
+	}
+	Utility::logger("Master stopping on signal " + Utility::to_string(g_master_stop_signal), MAGENTA);
+	for (std::map<pid_t, time_t>::iterator it = workers.begin(); it != workers.end(); ++it)
+		kill(it->first, SIGTERM);
+	for (std::map<pid_t, time_t>::iterator it = workers.begin(); it != workers.end(); ++it)
+		waitpid(it->first, NULL, 0);
+}
+
 void Webserver::start()
 {
 	try
@@ -15,11 +147,21 @@ void Webserver::start()
 		validator.validate();
 		Config::ConfigTokenizer tokenizer(validator.get_file_content());
 		tokenizer.tokenize_server_blocks();
-		Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+		Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
 		parser.parse();
 		// config.print_servers_info();
 		config.check_parsed_data();
 		Utility::logger("Server configured with  : " + _file_path, B_RED);
+		Utility::OpenFileCache::configure(config.get_open_file_cache(), config.get_open_file_cache_valid());
+		Utility::ContentCache::configure(config.get_content_cache(), config.get_content_cache_max_file());
+		if (config.get_worker_threads() > 1) {
+			_run_worker_threads(&config);
+			return;
+		}
+		if (config.get_worker_processes() > 1) {
+			_run_worker_processes(&config);
+			return;
+		}
 		HTTP::Server server(&config);
 		server.run();
 	}
@@ -12,6 +12,9 @@ class Webserver
 {
 private:
 	std::string _file_path;
+
+	void _run_worker_threads(Config::ConfigData *config);
+	void _run_worker_processes(Config::ConfigData *config);
 public:
 	Webserver(std::string file_path);
 	~Webserver();
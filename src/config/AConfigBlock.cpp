@@ -1,6 +1,7 @@
 #include "AConfigBlock.hpp"
 #include "../Utility/Utility.hpp"
-#include <cstdlib> // for atoi
+#include <cstdlib> // for atoi, strtol
+#include <cerrno>
 #include "../Constants.hpp"
 
 namespace Config
@@ -8,6 +9,7 @@ namespace Config
 
     AConfigBlock::AConfigBlock() {
         _is_size_default = false;
+        _is_buffer_size_default = false;
         _index_page = "index.html"; //default
     }
 
@@ -23,6 +25,8 @@ namespace Config
         _error_page = other._error_page;
         _client_max_body_size = other._client_max_body_size;
         _is_size_default = other._is_size_default;
+        _client_body_buffer_size = other._client_body_buffer_size;
+        _is_buffer_size_default = other._is_buffer_size_default;
         _index_page = other._index_page;
         return *this;
     }
@@ -69,22 +73,43 @@ namespace Config
             throw std::logic_error("client_max_body_size directive is duplicate");
 		if (args.size() != 2)
 			throw std::logic_error("invalid number of arguments in client_max_body_size");
-		_check_size(args[1]);
     }
 
-    void AConfigBlock::_check_size(std::string& size)
+    // bytes, or kilo-, mega- or gigabytes with a k, m or g suffix
+    long AConfigBlock::_check_size(std::string size, const std::string& directive) const
 	{
-        if(size[size.size() - 1] == 'K')
-            Utility::remove_last_of('K', size);
-        else if(size[size.size() - 1] == 'k')
-            Utility::remove_last_of('k', size);
+        long multiplier = 1;
+        char suffix = size.empty() ? '\0' : size[size.size() - 1];
+        if (suffix == 'K' || suffix == 'k')
+            multiplier = 1024;
+        else if (suffix == 'M' || suffix == 'm')
+            multiplier = 1024 * 1024;
+        else if (suffix == 'G' || suffix == 'g')
+            multiplier = 1024 * 1024 * 1024;
+        if (multiplier != 1)
+            size.erase(size.size() - 1);
 		if(Utility::is_positive_integer(size) == false)
-            throw std::logic_error("client_max_body_size directive invalid value " + size);
-        size_t size_num = std::atoi(size.c_str());
-        if (size_num < 0 || size_num > Constants::DEFAULT_MAX_SIZE_BODY)
-            throw std::out_of_range("client_max_body_size directive invalid valuee " + size);
+            throw std::logic_error(directive + " directive invalid value " + size);
+        errno = 0;
+        long size_num = std::strtol(size.c_str(), NULL, 10);
+        if (errno == ERANGE || size_num > Constants::MAX_CLIENT_BODY_SIZE / multiplier)
+            throw std::out_of_range(directive + " directive invalid value " + size);
+        return size_num * multiplier;
 	}
 
+    // directives that are switched on or off
+    size_t AConfigBlock::_check_switch_syntax(std::vector<std::string>& args, const std::string& directive) const
+    {
+        if (args.size() != 2)
+            throw std::runtime_error("invalid number of arguments in " + directive + " directive");
+        else if (args[1].compare("on") == 0)
+            return ON;
+        else if (args[1].compare("off") == 0)
+            return OFF;
+        else
+            throw std::runtime_error("invalid method " + args[1] + " in " + directive + " directive, it must be on or off");
+    }
+
     /* setters */
     void AConfigBlock::set_return_value(std::string& str)
     {
@@ -119,10 +144,23 @@ namespace Config
         Utility::remove_last_of(';', str);
         std::vector<std::string> args = Utility::split_string_by_white_space(str);
         _check_client_max_body_size_syntax(args);
-        _client_max_body_size = atoi(args[1].c_str());
+        _client_max_body_size = _check_size(args[1], "client_max_body_size");
         _is_size_default = false;
     }
 
+    // a body bigger than that is written to a temporary file instead of being kept in memory
+    void AConfigBlock::set_client_body_buffer_size(std::string& str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (_is_buffer_size_default == false)
+            throw std::logic_error("client_body_buffer_size directive is duplicate");
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in client_body_buffer_size");
+        _client_body_buffer_size = _check_size(args[1], "client_body_buffer_size");
+        _is_buffer_size_default = false;
+    }
+
     void AConfigBlock::set_index_page(std::string& str)
     {
         Utility::remove_last_of(';', str);
@@ -136,7 +174,7 @@ namespace Config
     }
 
     /* getters */
-    int AConfigBlock::get_client_max_body_size(void) const
+    long AConfigBlock::get_client_max_body_size(void) const
     {
         return _client_max_body_size;
     }
@@ -146,6 +184,16 @@ namespace Config
         return _is_size_default;
     }
 
+    long AConfigBlock::get_client_body_buffer_size(void) const
+    {
+        return _client_body_buffer_size;
+    }
+
+    bool AConfigBlock::get_is_buffer_size_default(void) const
+    {
+        return _is_buffer_size_default;
+    }
+
     const std::map<int, std::string>& AConfigBlock::get_return(void) const
     {
         return _return;
@@ -15,8 +15,10 @@ namespace Config
 		std::string _root;
 		std::map<int, std::string> _return;
 		std::map<int, std::string> _error_page;
-		int _client_max_body_size;
+		long _client_max_body_size;
 		bool _is_size_default;
+		long _client_body_buffer_size;
+		bool _is_buffer_size_default;
 		std::string _index_page;
 
 		/* check methods */
@@ -24,7 +26,8 @@ namespace Config
 		void _check_error_page_syntax(std::vector<std::string>& args) const;
 		void _check_root_syntax(std::vector<std::string>& args) const;
 		void _check_client_max_body_size_syntax(std::vector<std::string>& args);
-		void _check_size(std::string& size);
+		long _check_size(std::string size, const std::string& directive) const;
+		size_t _check_switch_syntax(std::vector<std::string>& args, const std::string& directive) const;
 
 	public:
 		AConfigBlock();
@@ -37,9 +40,12 @@ namespace Config
 		void set_root_value(std::string& str);
 		void set_error_page_value(std::string& str);
 		void set_client_max_body_size(std::string& str);
+		void set_client_body_buffer_size(std::string& str);
 		void set_index_page(std::string& str);
-		int get_client_max_body_size(void) const;
+		long get_client_max_body_size(void) const;
 		bool get_is_size_default(void) const;
+		long get_client_body_buffer_size(void) const;
+		bool get_is_buffer_size_default(void) const;
 		const std::string& get_root(void) const;
 		const std::map<int, std::string>& get_return(void) const;
 		const std::map<int, std::string>& get_error_page(void) const;
@@ -1,10 +1,12 @@
 #include "ConfigData.hpp"
 #include "../Constants.hpp"
+#include "../Utility/Utility.hpp"
+#include <cstdlib> // for atoi
 
 namespace Config
 {
 
-    ConfigData::ConfigData() { }
+    ConfigData::ConfigData() : _event_batch_size(Constants::DEFAULT_EVENT_BATCH_SIZE), _event_backend(""), _worker_threads(1), _worker_processes(1), _open_file_cache(0), _open_file_cache_valid(Constants::DEFAULT_OPEN_FILE_CACHE_VALID), _content_cache(0), _content_cache_max_file(Constants::DEFAULT_CONTENT_CACHE_MAX_FILE) { }
 
     ConfigData::ConfigData(const ConfigData &other)
     {
@@ -14,6 +16,14 @@ namespace Config
     const ConfigData &ConfigData::operator=(const ConfigData &other)
     {
         _servers = other._servers;
+        _event_batch_size = other._event_batch_size;
+        _event_backend = other._event_backend;
+        _worker_threads = other._worker_threads;
+        _worker_processes = other._worker_processes;
+        _open_file_cache = other._open_file_cache;
+        _open_file_cache_valid = other._open_file_cache_valid;
+        _content_cache = other._content_cache;
+        _content_cache_max_file = other._content_cache_max_file;
         return *this;
     }
 
@@ -35,6 +45,162 @@ namespace Config
 		return (_servers);
 	}
 
+    void ConfigData::set_event_batch_size(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in event_batch_size directive");
+        if (Utility::is_positive_integer(args[1]) == false || args[1].size() > 9)
+            throw std::logic_error("event_batch_size directive invalid value " + args[1]);
+        int value = std::atoi(args[1].c_str());
+        if (value < 1 || value > Constants::MAX_EVENT_BATCH_SIZE)
+            throw std::logic_error("event_batch_size directive out of range " + args[1]);
+        _event_batch_size = value;
+    }
+
+    int ConfigData::get_event_batch_size(void) const
+    {
+        return _event_batch_size;
+    }
+
+    // empty means the native mechanism of the platform
+    void ConfigData::set_event_backend(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in event_backend directive");
+        if (args[1] != "epoll" && args[1] != "kqueue" && args[1] != "io_uring")
+            throw std::logic_error("event_backend directive invalid value " + args[1]);
+        _event_backend = args[1];
+    }
+
+    const std::string &ConfigData::get_event_backend(void) const
+    {
+        return _event_backend;
+    }
+
+    // number of event loops, each one on its own thread with its own listening sockets
+    void ConfigData::set_worker_threads(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in worker_threads directive");
+        if (Utility::is_positive_integer(args[1]) == false || args[1].size() > 9)
+            throw std::logic_error("worker_threads directive invalid value " + args[1]);
+        int value = std::atoi(args[1].c_str());
+        if (value < 1 || value > Constants::MAX_WORKER_THREADS)
+            throw std::logic_error("worker_threads directive out of range " + args[1]);
+        _worker_threads = value;
+    }
+
+    int ConfigData::get_worker_threads(void) const
+    {
+        return _worker_threads;
+    }
+
+    // number of worker processes forked by the master, 1 means no master at all
+    void ConfigData::set_worker_processes(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in worker_processes directive");
+        if (Utility::is_positive_integer(args[1]) == false || args[1].size() > 9)
+            throw std::logic_error("worker_processes directive invalid value " + args[1]);
+        int value = std::atoi(args[1].c_str());
+        if (value < 1 || value > Constants::MAX_WORKER_PROCESSES)
+            throw std::logic_error("worker_processes directive out of range " + args[1]);
+        _worker_processes = value;
+    }
+
+    int ConfigData::get_worker_processes(void) const
+    {
+        return _worker_processes;
+    }
+
+    // the number of paths kept in the open file cache, 0 turns it off
+    void ConfigData::set_open_file_cache(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in open_file_cache directive");
+        if (Utility::is_positive_integer(args[1]) == false || args[1].size() > 9)
+            throw std::logic_error("open_file_cache directive invalid value " + args[1]);
+        int value = std::atoi(args[1].c_str());
+        if (value > Constants::MAX_OPEN_FILE_CACHE)
+            throw std::logic_error("open_file_cache directive out of range " + args[1]);
+        _open_file_cache = value;
+    }
+
+    int ConfigData::get_open_file_cache(void) const
+    {
+        return _open_file_cache;
+    }
+
+    // seconds a cached lookup is trusted before the file is looked at again
+    void ConfigData::set_open_file_cache_valid(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in open_file_cache_valid directive");
+        if (Utility::is_positive_integer(args[1]) == false || args[1].size() > 9)
+            throw std::logic_error("open_file_cache_valid directive invalid value " + args[1]);
+        int value = std::atoi(args[1].c_str());
+        if (value < 1 || value > Constants::MAX_OPEN_FILE_CACHE_VALID)
+            throw std::logic_error("open_file_cache_valid directive out of range " + args[1]);
+        _open_file_cache_valid = value;
+    }
+
+    int ConfigData::get_open_file_cache_valid(void) const
+    {
+        return _open_file_cache_valid;
+    }
+
+    // bytes of small files kept in memory, 0 turns the content cache off
+    void ConfigData::set_content_cache(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in content_cache directive");
+        if (Utility::is_positive_integer(args[1]) == false || args[1].size() > 9)
+            throw std::logic_error("content_cache directive invalid value " + args[1]);
+        int value = std::atoi(args[1].c_str());
+        if (value > Constants::MAX_CONTENT_CACHE)
+            throw std::logic_error("content_cache directive out of range " + args[1]);
+        _content_cache = value;
+    }
+
+    int ConfigData::get_content_cache(void) const
+    {
+        return _content_cache;
+    }
+
+    // files bigger than this are always sent from disk
+    void ConfigData::set_content_cache_max_file(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in content_cache_max_file directive");
+        if (Utility::is_positive_integer(args[1]) == false || args[1].size() > 9)
+            throw std::logic_error("content_cache_max_file directive invalid value " + args[1]);
+        int value = std::atoi(args[1].c_str());
+        if (value < 1 || value > Constants::MAX_CONTENT_CACHE)
+            throw std::logic_error("content_cache_max_file directive out of range " + args[1]);
+        _content_cache_max_file = value;
+    }
+
+    int ConfigData::get_content_cache_max_file(void) const
+    {
+        return _content_cache_max_file;
+    }
+
 	void ConfigData::check_parsed_data(void)
 	{
 		std::string tmp = "root wwww;";
@@ -133,7 +299,9 @@ namespace Config
             std::cout << RED << "\n\tLocation Number " << i + 1 << RESET << std::endl;
             std::cout << GREEN << "\troute: " << locations[i].get_route() << std::endl;
             std::cout << BLUE << "\tauto_index: " << locations[i].get_autoindex() << RESET << std::endl;
+            std::cout << BLUE << "\tstatic_precompressed: " << locations[i].get_static_precompressed() << RESET << std::endl;
             std::cout << GREEN << "\tclient_max_body_size: " << locations[i].get_client_max_body_size() << RESET << std::endl;
+            std::cout << GREEN << "\tclient_body_buffer_size: " << locations[i].get_client_body_buffer_size() << RESET << std::endl;
             print_limit_except(locations[i]);
             std::cout << "\t";
             print_root((ServerBlock &)locations[i]);
@@ -156,6 +324,7 @@ namespace Config
             print_server_name(_servers[i]);
             print_root(_servers[i]);
             std::cout << GREEN << "client_max_body_size: " << _servers[i].get_client_max_body_size() << RESET << std::endl;
+            std::cout << GREEN << "client_body_buffer_size: " << _servers[i].get_client_body_buffer_size() << RESET << std::endl;
             print_returns(_servers[i]);
             print_error_pages(_servers[i]);
             print_multiple_locations_info(_servers[i]);
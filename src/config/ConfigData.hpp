@@ -12,6 +12,14 @@ namespace Config
 	private:
 		/* data */
 		std::vector<ServerBlock> _servers;
+		int _event_batch_size;
+		std::string _event_backend;
+		int _worker_threads;
+		int _worker_processes;
+		int _open_file_cache;
+		int _open_file_cache_valid;
+		int _content_cache;
+		int _content_cache_max_file;
 
 	public:
 		ConfigData(/* args */);
@@ -26,6 +34,22 @@ namespace Config
 		void make_first_server_default();
 		void set_a_server(const ServerBlock &server);
 		const std::vector<ServerBlock> &get_servers(void) const;
+		void set_event_batch_size(std::string str);
+		int get_event_batch_size(void) const;
+		void set_event_backend(std::string str);
+		const std::string &get_event_backend(void) const;
+		void set_worker_threads(std::string str);
+		int get_worker_threads(void) const;
+		void set_worker_processes(std::string str);
+		int get_worker_processes(void) const;
+		void set_open_file_cache(std::string str);
+		int get_open_file_cache(void) const;
+		void set_open_file_cache_valid(std::string str);
+		int get_open_file_cache_valid(void) const;
+		void set_content_cache(std::string str);
+		int get_content_cache(void) const;
+		void set_content_cache_max_file(std::string str);
+		int get_content_cache_max_file(void) const;
 
 		/* print methods */
 		void print_servers_info(void);
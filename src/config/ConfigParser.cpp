@@ -5,8 +5,9 @@
 namespace Config
 {
 
-	ConfigParser::ConfigParser(ConfigData *config_data, std::vector<std::string> server_tokens) : config_data(config_data),
-																								   server_tokens(server_tokens)
+	ConfigParser::ConfigParser(ConfigData *config_data, std::vector<std::string> server_tokens, std::string main_tokens) : config_data(config_data),
+																								   server_tokens(server_tokens),
+																								   main_tokens(main_tokens)
 	{
 	}
 
@@ -21,11 +22,14 @@ namespace Config
 
 	int ConfigParser::find_directive(std::string& line)
 	{
-		const char *directive_list[13] =
+		const char *directive_list[21] =
 			{"listen", "server_name", "client_max_body_size",
 			 "error_page", "return", "root", "limit_except",
-			 "autoindex", "location", "ext", "index", "upload_dir", NULL};
-		for (size_t i = 0; i < 12; i++)
+			 "autoindex", "location", "ext", "index", "upload_dir",
+			 "keepalive_timeout", "keepalive_requests", "static_precompressed",
+			 "gzip", "gzip_types", "gzip_min_length", "gzip_comp_level",
+			 "client_body_buffer_size", NULL};
+		for (size_t i = 0; i < 20; i++)
 		{
 			if (Utility::check_first_keyword(line, directive_list[i]))
 				return i;
@@ -77,6 +81,8 @@ namespace Config
 			server.set_server_name(line);
 		else if (e_num == BODY_SIZE)
 			server.set_client_max_body_size(line);
+		else if (e_num == BODY_BUFFER_SIZE)
+			server.set_client_body_buffer_size(line);
 		else if (e_num == ERROR_PAGE)
 			server.set_error_page_value(line);
 		else if (e_num == RETURN)
@@ -87,6 +93,18 @@ namespace Config
 			server.set_extention_list(line);
 		else if (e_num == INDEX_PAGE)
 			server.set_index_page(line);
+		else if (e_num == KEEPALIVE_TIMEOUT)
+			server.set_keepalive_timeout(line);
+		else if (e_num == KEEPALIVE_REQUESTS)
+			server.set_keepalive_requests(line);
+		else if (e_num == GZIP)
+			server.set_gzip(line);
+		else if (e_num == GZIP_TYPES)
+			server.set_gzip_types(line);
+		else if (e_num == GZIP_MIN_LENGTH)
+			server.set_gzip_min_length(line);
+		else if (e_num == GZIP_COMP_LEVEL)
+			server.set_gzip_comp_level(line);
 		else
 			throw std::runtime_error("unknown directive in server block" + line);
 
@@ -100,6 +118,8 @@ namespace Config
 			location.set_error_page_value(line);
 		else if (e_num == BODY_SIZE)
 			location.set_client_max_body_size(line);
+		else if (e_num == BODY_BUFFER_SIZE)
+			location.set_client_body_buffer_size(line);
 		else if (e_num == ROUTE)
 			location.set_route(line);
 		else if (e_num == RETURN)
@@ -108,6 +128,8 @@ namespace Config
 			location.set_limit_except(line);
 		else if (e_num == AUTOINDEX)
 			location.set_autoindex(line);
+		else if (e_num == STATIC_PRECOMPRESSED)
+			location.set_static_precompressed(line);
 		else if (e_num == INDEX_PAGE)
 			location.set_index_page(line);
 		else if (e_num == UPLOAD)
@@ -133,8 +155,40 @@ namespace Config
 		}
 	}
 
+	void ConfigParser::parse_main_directives(void)
+	{
+		std::string line;
+		std::istringstream stream(main_tokens);
+
+		while (std::getline(stream, line))
+		{
+			if (Utility::check_first_keyword(line, "event_batch_size"))
+				config_data->set_event_batch_size(line);
+			else if (Utility::check_first_keyword(line, "event_backend"))
+				config_data->set_event_backend(line);
+			else if (Utility::check_first_keyword(line, "worker_threads"))
+				config_data->set_worker_threads(line);
+			else if (Utility::check_first_keyword(line, "worker_processes"))
+				config_data->set_worker_processes(line);
+			else if (Utility::check_first_keyword(line, "open_file_cache"))
+				config_data->set_open_file_cache(line);
+			else if (Utility::check_first_keyword(line, "open_file_cache_valid"))
+				config_data->set_open_file_cache_valid(line);
+			else if (Utility::check_first_keyword(line, "content_cache"))
+				config_data->set_content_cache(line);
+			else if (Utility::check_first_keyword(line, "content_cache_max_file"))
+				config_data->set_content_cache_max_file(line);
+			else
+				throw std::runtime_error("unknown directive " + line);
+		}
+		// the threads bind their own sockets while the workers share the ones of the master
+		if (config_data->get_worker_threads() > 1 && config_data->get_worker_processes() > 1)
+			throw std::runtime_error("worker_threads and worker_processes cannot be combined");
+	}
+
 	void ConfigParser::parse(void)
 	{
+		parse_main_directives();
 		for (size_t i = 0; i < server_tokens.size(); i++)
 		{
 			ServerBlock server;
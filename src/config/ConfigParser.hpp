@@ -18,6 +18,7 @@ namespace Config
 		/* data */
 		ConfigData *config_data;
 		std::vector<std::string> server_tokens;
+		std::string main_tokens;
 		enum Directives
 		{
 			LISTEN,
@@ -31,7 +32,15 @@ namespace Config
 			ROUTE,
 			EXT,
 			INDEX_PAGE,
-			UPLOAD
+			UPLOAD,
+			KEEPALIVE_TIMEOUT,
+			KEEPALIVE_REQUESTS,
+			STATIC_PRECOMPRESSED,
+			GZIP,
+			GZIP_TYPES,
+			GZIP_MIN_LENGTH,
+			GZIP_COMP_LEVEL,
+			BODY_BUFFER_SIZE
 		};
 
 		/* methods */
@@ -42,9 +51,10 @@ namespace Config
 		void parse_server_directive(std::string& line, ServerBlock &server, int e_num);
 		void parse_location_directive(std::string& line, LocationBlock &location, int e_num);
 		void parse_limit_except(std::string& line, LocationBlock &location, std::istringstream &stream);
+		void parse_main_directives(void);
 
 	public:
-		ConfigParser(ConfigData *config_data, std::vector<std::string> server_tokens);
+		ConfigParser(ConfigData *config_data, std::vector<std::string> server_tokens, std::string main_tokens = "");
 		~ConfigParser();
 
 		void parse(void);
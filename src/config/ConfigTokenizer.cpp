@@ -16,15 +16,24 @@ namespace Config
 		std::string line;
 		std::string single_server_block;
 		std::istringstream stream(_file_content);
+		bool server_on = false;
 
 		while (std::getline(stream, line))
 		{
-			if (line.find("location") != std::string::npos)
+			if (server_on == false)
+			{
+				if (line.find("server") != std::string::npos)
+					server_on = true;
+				else
+					_main_tokens.append(line + "\n"); // validator made sure these are main context directives
+			}
+			else if (line.find("location") != std::string::npos)
 				_tokenize_location_block(line, stream, single_server_block);
 			else if (line.find("}") != std::string::npos)
 			{
 				_server_tokens.push_back(single_server_block);
 				single_server_block.clear();
+				server_on = false;
 			}
 			else if (line.find("server_name") != std::string::npos)
 				single_server_block.append(line + "\n");
@@ -69,4 +78,9 @@ namespace Config
 		return _server_tokens;
 	}
 
+	const std::string& ConfigTokenizer::get_main_tokens(void) const
+	{
+		return _main_tokens;
+	}
+
 } // namespace Config
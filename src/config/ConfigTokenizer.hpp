@@ -14,6 +14,7 @@ namespace Config
 		/* data */
 		std::string _file_content;
 		std::vector<std::string> _server_tokens;
+		std::string _main_tokens;
 
 		/* methods */
 		void _tokenize_location_block(std::string line, std::istringstream &stream, std::string &single_server_block);
@@ -25,5 +26,6 @@ namespace Config
 		void tokenize_server_blocks(void);
 		void print_server_blocks(void);
 		const std::vector<std::string>& get_server_tokens(void) const;
+		const std::string& get_main_tokens(void) const;
 	};
 } // namespace Config
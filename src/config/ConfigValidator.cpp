@@ -100,10 +100,28 @@ namespace Config
 	{
 		std::string temp = line;
 		Utility::remove_white_space(temp);
+		if (_is_main_directive(line))
+		{
+			_check_semi_colon(line);
+			return;
+		}
 		if(!temp.empty())
 			throw std::runtime_error("Invalid-Config: Information outside of server blocks");
 	}
 
+	// the few directives that apply to the whole process instead of a single server block
+	bool ConfigValidator::_is_main_directive(std::string line)
+	{
+		const char *main_directives[] = {"event_batch_size", "event_backend", "worker_threads", "worker_processes",
+			"open_file_cache", "open_file_cache_valid", "content_cache", "content_cache_max_file", NULL};
+		for (size_t i = 0; main_directives[i] != NULL; i++)
+		{
+			if (Utility::check_first_keyword(line, main_directives[i]))
+				return true;
+		}
+		return false;
+	}
+
 	void ConfigValidator::_validate_location_opening(std::string line)
 	{
 		std::vector<std::string> location_split;
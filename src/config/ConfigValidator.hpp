@@ -23,6 +23,7 @@ namespace Config
 		void _validate_server_blocks(void);
 		bool _validate_server_opening(std::string line);
 		void _check_outside_of_server_block(std::string line);
+		bool _is_main_directive(std::string line);
 		void _validate_location_block(std::string line, std::istringstream &stream);
 		void _validate_location_opening(std::string line);
 		void _validate_limit_except(std::string line, std::istringstream &stream);
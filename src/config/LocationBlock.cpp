@@ -9,8 +9,11 @@ namespace Config
     LocationBlock::LocationBlock()
     {
         _autoindex = OFF; //default nginx
+        _static_precompressed = OFF;
         _client_max_body_size = Constants::DEFAULT_MAX_SIZE_BODY;
         _is_size_default = true;
+        _client_body_buffer_size = Constants::DEFAULT_CLIENT_BODY_BUFFER_SIZE;
+        _is_buffer_size_default = true;
         _upload_dir = "files"; //default
     }
 
@@ -24,11 +27,14 @@ namespace Config
         _route = other._route;
         _limit_except = other._limit_except;
         _autoindex = other._autoindex;
+        _static_precompressed = other._static_precompressed;
         _root = other._root;
         _return = other._return;
         _error_page = other._error_page;
         _client_max_body_size = other._client_max_body_size;
         _is_size_default = other._is_size_default;
+        _client_body_buffer_size = other._client_body_buffer_size;
+        _is_buffer_size_default = other._is_buffer_size_default;
         _index_page = other._index_page;
         _upload_dir = other._upload_dir;
         return *this;
@@ -59,18 +65,6 @@ namespace Config
         }
     }
 
-    size_t LocationBlock::_check_autoindex_syntax(std::vector<std::string>& args) const
-    {
-        if (args.size() != 2)
-            throw std::runtime_error("invalid number of arguments in autoindex directive");
-        else if (args[1].compare("on") == 0)
-            return ON;
-        else if (args[1].compare("off") == 0)
-            return OFF;
-        else
-            throw std::runtime_error("invalid method " + args[1] + " in autoindex directive, it must be on or off");
-    }
-
     /* getters & setters */
     void LocationBlock::set_route(std::string str)
     {
@@ -102,7 +96,7 @@ namespace Config
     {
         Utility::remove_last_of(';', str);
         std::vector<std::string> args = Utility::split_string_by_white_space(str);
-        _autoindex = _check_autoindex_syntax(args);
+        _autoindex = _check_switch_syntax(args, "autoindex");
     }
 
     int LocationBlock::get_autoindex() const
@@ -110,6 +104,18 @@ namespace Config
         return _autoindex;
     }
 
+    void LocationBlock::set_static_precompressed(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        _static_precompressed = _check_switch_syntax(args, "static_precompressed");
+    }
+
+    int LocationBlock::get_static_precompressed() const
+    {
+        return _static_precompressed;
+    }
+
     const std::string& LocationBlock::get_route() const
     {
         return _route;
@@ -11,13 +11,13 @@ namespace Config
 	{
 	private:
 		int _autoindex;
+		int _static_precompressed;
 		std::string _route;
 		std::string _upload_dir;
 		std::vector<std::string> _limit_except;
 	
 		/* check methods */
 		void _check_limit_except(std::vector<std::string>& args) const;
-		size_t _check_autoindex_syntax(std::vector<std::string>& args) const;
 		
 	public:
 		LocationBlock();
@@ -31,6 +31,8 @@ namespace Config
 		void set_limit_except(std::string str);
 		void set_autoindex(std::string str);
 		int get_autoindex(void) const;
+		void set_static_precompressed(std::string str);
+		int get_static_precompressed(void) const;
 		const std::string& get_route(void) const;
 		const std::string& get_upload_dir(void) const;
 		const std::vector<std::string>& get_limit_except(void) const;
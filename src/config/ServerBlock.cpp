@@ -11,6 +11,14 @@ namespace Config
         _is_default = false;
         _client_max_body_size = Constants::DEFAULT_MAX_SIZE_BODY;
          _is_size_default = true;
+        _client_body_buffer_size = Constants::DEFAULT_CLIENT_BODY_BUFFER_SIZE;
+        _is_buffer_size_default = true;
+        _keepalive_timeout = Constants::DEFAULT_KEEPALIVE_TIMEOUT;
+        _keepalive_requests = Constants::DEFAULT_KEEPALIVE_REQUESTS;
+        _gzip = OFF;
+        _gzip_types.push_back("text/html"); // always compressed, like in nginx
+        _gzip_min_length = Constants::DEFAULT_GZIP_MIN_LENGTH;
+        _gzip_comp_level = Constants::DEFAULT_GZIP_COMP_LEVEL;
     }
 
     ServerBlock::ServerBlock(const ServerBlock &other)
@@ -29,9 +37,17 @@ namespace Config
         _return = other._return;
         _error_page = other._error_page;
         _is_size_default = other._is_size_default;
+        _client_body_buffer_size = other._client_body_buffer_size;
+        _is_buffer_size_default = other._is_buffer_size_default;
         _id = other._id;
         _cgi_extention_list = other._cgi_extention_list;
         _index_page = other._index_page;
+        _keepalive_timeout = other._keepalive_timeout;
+        _keepalive_requests = other._keepalive_requests;
+        _gzip = other._gzip;
+        _gzip_types = other._gzip_types;
+        _gzip_min_length = other._gzip_min_length;
+        _gzip_comp_level = other._gzip_comp_level;
         return *this;
     }
 
@@ -80,6 +96,36 @@ namespace Config
 			throw std::logic_error("invalid number of arguments in server_name directive");
 	}
 
+    // keepalive_timeout takes seconds with an optional 's' suffix, keepalive_requests a plain number
+    int ServerBlock::_check_and_return_keepalive_value(std::string& str, const std::string& directive) const
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in " + directive + " directive");
+        std::string value = args[1];
+        if (directive == "keepalive_timeout" && value.size() > 1 && value[value.size() - 1] == 's')
+            Utility::remove_last_of('s', value);
+        if (Utility::is_positive_integer(value) == false || value.size() > 9)
+            throw std::logic_error(directive + " directive invalid value " + args[1]);
+        return std::atoi(value.c_str());
+    }
+
+    // gzip_min_length takes bytes, gzip_comp_level a zlib level from 1 to 9
+    int ServerBlock::_check_and_return_gzip_value(std::string& str, const std::string& directive, int min, int max) const
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() != 2)
+            throw std::logic_error("invalid number of arguments in " + directive + " directive");
+        if (Utility::is_positive_integer(args[1]) == false || args[1].size() > 9)
+            throw std::logic_error(directive + " directive invalid value " + args[1]);
+        int value = std::atoi(args[1].c_str());
+        if (value < min || value > max)
+            throw std::out_of_range(directive + " directive invalid value " + args[1]);
+        return value;
+    }
+
     /* setters */
     void ServerBlock::set_listen(std::string str)
     {
@@ -115,6 +161,48 @@ namespace Config
             _cgi_extention_list.push_back(args[i]);
     }
 
+    void ServerBlock::set_keepalive_timeout(std::string str)
+    {
+        _keepalive_timeout = _check_and_return_keepalive_value(str, "keepalive_timeout");
+    }
+
+    void ServerBlock::set_keepalive_requests(std::string str)
+    {
+        _keepalive_requests = _check_and_return_keepalive_value(str, "keepalive_requests");
+    }
+
+    void ServerBlock::set_gzip(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        _gzip = _check_switch_syntax(args, "gzip");
+    }
+
+    // MIME types compressed next to text/html, * for every type
+    void ServerBlock::set_gzip_types(std::string str)
+    {
+        Utility::remove_last_of(';', str);
+        std::vector<std::string> args = Utility::split_string_by_white_space(str);
+        if (args.size() < 2)
+            throw std::logic_error("invalid number of arguments in gzip_types directive");
+        for (size_t i = 1; i < args.size(); i++)
+        {
+            if (args[i] != "*" && args[i].find('/') == std::string::npos)
+                throw std::logic_error("gzip_types directive invalid MIME type " + args[i]);
+            _gzip_types.push_back(args[i]);
+        }
+    }
+
+    void ServerBlock::set_gzip_min_length(std::string str)
+    {
+        _gzip_min_length = _check_and_return_gzip_value(str, "gzip_min_length", 0, Constants::DEFAULT_MAX_SIZE_BODY);
+    }
+
+    void ServerBlock::set_gzip_comp_level(std::string str)
+    {
+        _gzip_comp_level = _check_and_return_gzip_value(str, "gzip_comp_level", 1, 9);
+    }
+
     void ServerBlock::set_id(int num) 
     {
         _id = num;
@@ -151,4 +239,34 @@ namespace Config
         return _cgi_extention_list;
     }
 
+    int ServerBlock::get_keepalive_timeout(void) const
+    {
+        return _keepalive_timeout;
+    }
+
+    int ServerBlock::get_keepalive_requests(void) const
+    {
+        return _keepalive_requests;
+    }
+
+    int ServerBlock::get_gzip(void) const
+    {
+        return _gzip;
+    }
+
+    const std::vector<std::string> &ServerBlock::get_gzip_types(void) const
+    {
+        return _gzip_types;
+    }
+
+    int ServerBlock::get_gzip_min_length(void) const
+    {
+        return _gzip_min_length;
+    }
+
+    int ServerBlock::get_gzip_comp_level(void) const
+    {
+        return _gzip_comp_level;
+    }
+
 } // namespace Config
@@ -18,6 +18,12 @@ namespace Config
 		std::vector<std::string> _server_name;
 		std::vector<LocationBlock> _locations;
 		std::vector<std::string> _cgi_extention_list;
+		int _keepalive_timeout;
+		int _keepalive_requests;
+		int _gzip;
+		std::vector<std::string> _gzip_types;
+		int _gzip_min_length;
+		int _gzip_comp_level;
 		int _id;
 		
 		/* check methods */
@@ -25,6 +31,8 @@ namespace Config
 		void _check_port_range(std::string& port);
 		void _check_duplicate_location_route(const std::string& route);
 		void _check_server_name_syntax(std::vector<std::string>& args) const;
+		int _check_and_return_keepalive_value(std::string& str, const std::string& directive) const;
+		int _check_and_return_gzip_value(std::string& str, const std::string& directive, int min, int max) const;
 
 	public:
 		ServerBlock();
@@ -39,11 +47,23 @@ namespace Config
 		void set_a_location(const LocationBlock &location);
 		void set_id(int num);
 		void set_extention_list(std::string str);
+		void set_keepalive_timeout(std::string str);
+		void set_keepalive_requests(std::string str);
+		void set_gzip(std::string str);
+		void set_gzip_types(std::string str);
+		void set_gzip_min_length(std::string str);
+		void set_gzip_comp_level(std::string str);
 		bool get_default(void) const;
 		const std::set<std::string> &get_listen(void) const;
 		const std::vector<std::string> &get_server_name(void) const;
 		const std::vector<LocationBlock> &get_location(void) const;
 		const std::vector<std::string> &get_extention_list(void) const;
+		int get_keepalive_timeout(void) const;
+		int get_keepalive_requests(void) const;
+		int get_gzip(void) const;
+		const std::vector<std::string> &get_gzip_types(void) const;
+		int get_gzip_min_length(void) const;
+		int get_gzip_comp_level(void) const;
 		int get_id(void) const;
 	};
 } // namespace Config
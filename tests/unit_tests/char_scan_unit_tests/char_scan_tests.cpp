@@ -0,0 +1,51 @@
+#include "../catch_amalgamated.hpp"
+
+#include <string>
+#include <cstring>
+
+#include "../../../src/Utility/CharScan.hpp"
+
+namespace tests {
+    static size_t reference_non_token(const std::string& str) {
+        const char* others = "!#$%&'*+-.^_`|~";
+        for (size_t i = 0; i < str.size(); i++) {
+            unsigned char c = str[i];
+            if (!(isalnum(c) && c < 0x80) && (c == '\0' || !strchr(others, c)))
+                return i;
+        }
+        return str.size();
+    }
+
+    static size_t reference_control_or(const std::string& str, char stop) {
+        for (size_t i = 0; i < str.size(); i++) {
+            unsigned char c = str[i];
+            if ((c < 0x20 && c != '\t') || c == 0x7F || str[i] == stop)
+                return i;
+        }
+        return str.size();
+    }
+
+    TEST_CASE ("Character scanning kernels", "[char_scan]") {
+        SECTION("every byte value at every position of the blocks and of the scalar tail"){
+            for (int c = 0; c < 256; c++) {
+                for (size_t position = 0; position < 70; position += 3) {
+                    std::string str(72, 'a');
+                    str[20] = '_';
+                    str[position] = static_cast<char>(c);
+                    CHECK(Utility::find_non_token(str.data(), str.size()) == reference_non_token(str));
+                    CHECK(Utility::find_control_or(str.data(), str.size(), ' ') == reference_control_or(str, ' '));
+                    CHECK(Utility::find_control_or(str.data(), str.size(), '\0') == reference_control_or(str, '\0'));
+                }
+            }
+        }
+        SECTION("a header line and a request line"){
+            std::string header = "X-Forwarded-For_Long.Name~1: 192.168.0.1\tproxy";
+            CHECK(Utility::find_non_token(header.data(), header.size()) == header.find(':'));
+            std::string value = header.substr(header.find(':') + 2);
+            CHECK(Utility::find_control_or(value.data(), value.size(), '\0') == value.size());
+            std::string target = "/a/rather/long/path/to/some/resource.html?with=query\xC3\xA9 HTTP/1.1";
+            CHECK(Utility::find_control_or(target.data(), target.size(), ' ') == target.find(' '));
+            CHECK(Utility::find_non_token("", 0) == 0);
+        }
+    }
+}
@@ -244,6 +244,30 @@ TEST_CASE("client_max_body_size directive check")
 	}
 }
 
+TEST_CASE("client_body_buffer_size directive check")
+{
+	SECTION("duplicate directives")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/client_body_buffer_size_2");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+	SECTION("invalid value 16kb")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/client_body_buffer_size_3");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+}
+
 TEST_CASE("limit_except directive check")
 {
 	SECTION("no args")
@@ -347,6 +371,188 @@ TEST_CASE("server_name directive check")
 	}
 }
 
+TEST_CASE("keepalive directives check")
+{
+	SECTION("timeout is not a number")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/keepalive_2");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+	SECTION("more than 1 arg")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/keepalive_3");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+}
+
+TEST_CASE("gzip directives check")
+{
+	SECTION("comp_level out of range")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/gzip_2");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+	SECTION("not a MIME type")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/gzip_3");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+	SECTION("gzip is not on or off")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/gzip_4");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+}
+
+TEST_CASE("event_batch_size directive check")
+{
+	SECTION("zero events")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/event_batch_size_2");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+	SECTION("more than 1 arg")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/event_batch_size_3");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+}
+
+TEST_CASE("event_backend directive check")
+{
+	SECTION("unknown backend")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/event_backend_1");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+}
+
+TEST_CASE("worker_threads directive check")
+{
+	SECTION("more threads than allowed")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/worker_threads_1");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+	SECTION("not a number")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/worker_threads_2");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+}
+
+TEST_CASE("worker_processes directive check")
+{
+	SECTION("combined with worker_threads")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/worker_processes_1");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+	SECTION("zero processes")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/worker_processes_2");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+}
+
+TEST_CASE("open_file_cache directive check")
+{
+	SECTION("too many entries")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/open_file_cache_1");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+	SECTION("zero seconds valid")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/open_file_cache_2");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+}
+
+TEST_CASE("content_cache directive check")
+{
+	SECTION("zero bytes per file")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/content_cache_1");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+}
+
 TEST_CASE("autoindex directive check")
 {
 	SECTION("no args")
@@ -380,3 +586,27 @@ TEST_CASE("autoindex directive check")
 	CHECK_THROWS(parser.parse());
 	}
 }
+
+TEST_CASE("static_precompressed directive check")
+{
+	SECTION("invalid arg")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/static_precompressed_1");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+	SECTION("not allowed in a server block")
+	{
+	Config::ConfigValidator validator("config_parser_tests/conf_files/static_precompressed_2");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigData config;
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	CHECK_THROWS(parser.parse());
+	}
+}
@@ -72,6 +72,7 @@ TEST_CASE("Parsing basic conf file")
 				std::map<int, std::string>::const_iterator it = locs[0].get_error_page().find(301);
 				CHECK(it->second == "/custom-301.html");
 				CHECK(locs[0].get_autoindex() == 1); //ON
+				CHECK(locs[0].get_static_precompressed() == 0); //OFF by default
 				CHECK(locs[0].get_limit_except().size() == 1);
 				CHECK(locs[0].get_limit_except()[0] == "POST");
 				CHECK(locs[0].get_return().size() == 1);
@@ -89,6 +90,7 @@ TEST_CASE("Parsing basic conf file")
 				//3rd loc
 				CHECK(locs[2].get_route() == "/whatssssup/");
 				CHECK(locs[2].get_autoindex() == 1); //
+				CHECK(locs[2].get_static_precompressed() == 1); //ON
 				CHECK(locs[2].get_root() == "/var/www/iremiremirem");
 				CHECK(locs[2].get_return().size() == 1);
 				it = locs[2].get_return().find(505);
@@ -120,3 +122,130 @@ TEST_CASE("Parsing basic conf file")
 	}
 	}
 }
+
+TEST_CASE("Parsing keepalive directives")
+{
+	Config::ConfigData config;
+	Config::ConfigValidator validator("config_parser_tests/conf_files/keepalive_1");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	parser.parse();
+
+	std::vector<Config::ServerBlock> servers = config.get_servers();
+	CHECK(servers.size() == 2);
+	SECTION("Values are taken from the directives, 's' suffix is allowed for the timeout")
+	{
+		CHECK(servers[0].get_keepalive_timeout() == 15);
+		CHECK(servers[0].get_keepalive_requests() == 50);
+	}
+	SECTION("keepalive_timeout 0 disables keep-alive, keepalive_requests keeps its default")
+	{
+		CHECK(servers[1].get_keepalive_timeout() == 0);
+		CHECK(servers[1].get_keepalive_requests() == 1000);
+	}
+}
+
+TEST_CASE("Parsing gzip directives")
+{
+	Config::ConfigData config;
+	Config::ConfigValidator validator("config_parser_tests/conf_files/gzip_1");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	parser.parse();
+
+	std::vector<Config::ServerBlock> servers = config.get_servers();
+	CHECK(servers.size() == 2);
+	SECTION("Values are taken from the directives, text/html stays in the types")
+	{
+		CHECK(servers[0].get_gzip() == 1); //ON
+		CHECK(servers[0].get_gzip_types().size() == 3);
+		CHECK(servers[0].get_gzip_types()[0] == "text/html");
+		CHECK(servers[0].get_gzip_types()[2] == "application/json");
+		CHECK(servers[0].get_gzip_min_length() == 256);
+		CHECK(servers[0].get_gzip_comp_level() == 6);
+	}
+	SECTION("gzip is off by default")
+	{
+		CHECK(servers[1].get_gzip() == 0); //OFF
+		CHECK(servers[1].get_gzip_types().size() == 1);
+		CHECK(servers[1].get_gzip_min_length() == 20);
+		CHECK(servers[1].get_gzip_comp_level() == 1);
+	}
+}
+
+TEST_CASE("Parsing client_body_buffer_size directives")
+{
+	Config::ConfigData config;
+	Config::ConfigValidator validator("config_parser_tests/conf_files/client_body_buffer_size_1");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens());
+	parser.parse();
+
+	std::vector<Config::ServerBlock> servers = config.get_servers();
+	SECTION("sizes with a suffix, client_max_body_size beyond 32 bits")
+	{
+		CHECK(servers[0].get_client_max_body_size() == 4L * 1024 * 1024 * 1024);
+		CHECK(servers[0].get_client_body_buffer_size() == 1048576);
+		CHECK(servers[0].get_is_buffer_size_default() == false);
+		CHECK(servers[0].get_location()[0].get_client_body_buffer_size() == 8192);
+		CHECK(servers[0].get_location()[0].get_is_buffer_size_default() == false);
+	}
+	SECTION("16k by default")
+	{
+		CHECK(servers[1].get_client_body_buffer_size() == 16384);
+		CHECK(servers[1].get_is_buffer_size_default() == true);
+	}
+}
+
+TEST_CASE("Parsing main context directives")
+{
+	Config::ConfigData config;
+	Config::ConfigValidator validator("config_parser_tests/conf_files/main_context_1");
+	validator.validate();
+	Config::ConfigTokenizer tokenizer(validator.get_file_content());
+	tokenizer.tokenize_server_blocks();
+	Config::ConfigParser parser(&config, tokenizer.get_server_tokens(), tokenizer.get_main_tokens());
+	parser.parse();
+
+	SECTION("event_batch_size, event_backend and worker_threads are taken from outside of the server blocks, which are parsed as before")
+	{
+		CHECK(config.get_event_batch_size() == 64);
+		CHECK(config.get_event_backend() == "io_uring");
+		CHECK(config.get_worker_threads() == 4);
+		CHECK(config.get_servers().size() == 2);
+	}
+	SECTION("defaults when not set: 512 events, native backend, a single thread and no worker processes")
+	{
+		Config::ConfigData default_config;
+		CHECK(default_config.get_event_batch_size() == 512);
+		CHECK(default_config.get_event_backend() == "");
+		CHECK(default_config.get_worker_threads() == 1);
+		CHECK(default_config.get_worker_processes() == 1);
+		CHECK(default_config.get_open_file_cache() == 0);
+		CHECK(default_config.get_open_file_cache_valid() == 60);
+		CHECK(default_config.get_content_cache() == 0);
+		CHECK(default_config.get_content_cache_max_file() == 65536);
+	}
+	SECTION("worker_processes and the file caches")
+	{
+		Config::ConfigData process_config;
+		Config::ConfigValidator process_validator("config_parser_tests/conf_files/main_context_2");
+		process_validator.validate();
+		Config::ConfigTokenizer process_tokenizer(process_validator.get_file_content());
+		process_tokenizer.tokenize_server_blocks();
+		Config::ConfigParser process_parser(&process_config, process_tokenizer.get_server_tokens(), process_tokenizer.get_main_tokens());
+		process_parser.parse();
+		CHECK(process_config.get_worker_processes() == 4);
+		CHECK(process_config.get_worker_threads() == 1);
+		CHECK(process_config.get_open_file_cache() == 1000);
+		CHECK(process_config.get_open_file_cache_valid() == 30);
+		CHECK(process_config.get_content_cache() == 1048576);
+		CHECK(process_config.get_content_cache_max_file() == 4096);
+	}
+}
@@ -0,0 +1,57 @@
+#include "../catch_amalgamated.hpp"
+
+#include <string>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+#include "../../../src/Utility/ContentCache.hpp"
+
+namespace tests {
+    static void write_file(const std::string& path, const std::string& content) {
+        std::ofstream file(path.c_str());
+        file << content;
+    }
+
+    TEST_CASE ("Content cache", "[content_cache]") {
+        std::string prefix = "/tmp/content_cache_test_" + std::to_string(getpid()) + "_";
+        Utility::ContentCache::configure(10, 6);
+        Utility::OpenFileCache::Info info;
+        Utility::SharedBuffer content;
+
+        SECTION("a hit shares the buffer of the cache"){
+            write_file(prefix + "a", "abc");
+            REQUIRE(Utility::ContentCache::find(prefix + "a", info, content));
+            CHECK(std::string(content.data(), content.size()) == "abc");
+            Utility::SharedBuffer again;
+            REQUIRE(Utility::ContentCache::find(prefix + "a", info, again));
+            CHECK(again.data() == content.data());
+        }
+        SECTION("a changed file is read again, the old buffer stays valid for its holders"){
+            write_file(prefix + "a", "abc");
+            REQUIRE(Utility::ContentCache::find(prefix + "a", info, content));
+            write_file(prefix + "a", "abcd");
+            Utility::SharedBuffer again;
+            REQUIRE(Utility::ContentCache::find(prefix + "a", info, again));
+            CHECK(std::string(again.data(), again.size()) == "abcd");
+            CHECK(std::string(content.data(), content.size()) == "abc");
+        }
+        SECTION("big files are left out, the byte budget drops the least recently used"){
+            write_file(prefix + "big", "1234567");
+            CHECK(!Utility::ContentCache::find(prefix + "big", info, content));
+            write_file(prefix + "a", "aaaa");
+            write_file(prefix + "b", "bbbb");
+            write_file(prefix + "c", "cccc");
+            CHECK(Utility::ContentCache::find(prefix + "a", info, content));
+            CHECK(Utility::ContentCache::find(prefix + "b", info, content));
+            CHECK(Utility::ContentCache::find(prefix + "c", info, content));
+            CHECK(Utility::ContentCache::count() == 2);
+            CHECK(Utility::ContentCache::size() == 8);
+        }
+        Utility::ContentCache::configure(0, 6);
+        CHECK(Utility::ContentCache::count() == 0);
+        const char *names[] = {"a", "b", "c", "big"};
+        for (size_t i = 0; i < 4; i++)
+            std::remove((prefix + names[i]).c_str());
+    }
+}
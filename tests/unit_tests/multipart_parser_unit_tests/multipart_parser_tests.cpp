@@ -0,0 +1,121 @@
+#include "../catch_amalgamated.hpp"
+
+#include <string>
+#include <vector>
+
+#include "../../../src/HTTPRequest/MultipartParser.hpp"
+
+namespace tests {
+    // keeps every part with its whole content
+    class RecordedParts : public HTTPRequest::MultipartParserDelegate {
+    public:
+        std::vector<HTTPRequest::MultipartPart> parts;
+        std::vector<std::string> contents;
+        bool accept;
+
+        RecordedParts() : accept(true) {}
+
+        bool begin_part(const HTTPRequest::MultipartPart& part) {
+            parts.push_back(part);
+            contents.push_back("");
+            return accept;
+        }
+        bool part_data(const char* data, size_t size) {
+            contents.back().append(data, size);
+            return true;
+        }
+        bool end_part() {
+            return true;
+        }
+    };
+
+    static const std::string BOUNDARY = "----WebKitFormBoundary7MA4YWxk";
+
+    static std::string binary_content() {
+        std::string content("\0\r\n--\r\n-", 8);
+        content += "\r\n--" + BOUNDARY.substr(0, 10); // the start of the delimiter, but not all of it
+        for (int i = 0; i < 256; i++) {
+            content += static_cast<char>(i);
+        }
+        return content + "\r\n";
+    }
+
+    static std::string form_body() {
+        return "preamble\r\n"
+            "--" + BOUNDARY + "\r\n"
+            "Content-Disposition: form-data; name=\"title\"\r\n"
+            "\r\n"
+            "hello\r\n"
+            "--" + BOUNDARY + "  \r\n" // transport padding
+            "content-disposition: form-data; name=\"file\"; filename=\"a;b \\\"c\\\".bin\"\r\n"
+            "Content-Type: application/octet-stream\r\n"
+            "\r\n"
+            + binary_content() +
+            "\r\n--" + BOUNDARY + "--\r\n"
+            "epilogue";
+    }
+
+    static void check_form_parts(const RecordedParts& recorded) {
+        REQUIRE(recorded.parts.size() == 2);
+        CHECK(recorded.parts[0].name == "title");
+        CHECK(recorded.parts[0].filename == "");
+        CHECK(recorded.contents[0] == "hello");
+        CHECK(recorded.parts[1].name == "file");
+        CHECK(recorded.parts[1].filename == "a;b \"c\".bin");
+        CHECK(recorded.parts[1].content_type == "application/octet-stream");
+        CHECK(recorded.contents[1] == binary_content());
+    }
+
+    TEST_CASE ("Multipart parser", "[multipart_parser]") {
+        SECTION("parts of a body fed at once, binary content is passed on unchanged"){
+            RecordedParts recorded;
+            HTTPRequest::MultipartParser parser(BOUNDARY, recorded);
+            std::string body = form_body();
+            CHECK(parser.feed(body.data(), body.size()));
+            CHECK(parser.is_finished());
+            check_form_parts(recorded);
+        }
+        SECTION("the same parts whatever the pieces the body comes in"){
+            std::string body = form_body();
+            for (size_t split = 1; split < body.size(); split++) {
+                RecordedParts recorded;
+                HTTPRequest::MultipartParser parser(BOUNDARY, recorded);
+                CHECK(parser.feed(body.data(), split));
+                CHECK(parser.feed(body.data() + split, body.size() - split));
+                CHECK(parser.is_finished());
+                check_form_parts(recorded);
+            }
+            RecordedParts recorded;
+            HTTPRequest::MultipartParser parser(BOUNDARY, recorded);
+            for (size_t i = 0; i < body.size(); i++) {
+                parser.feed(body.data() + i, 1);
+            }
+            CHECK(parser.is_finished());
+            check_form_parts(recorded);
+        }
+        SECTION("a body without its closing delimiter is not finished"){
+            RecordedParts recorded;
+            HTTPRequest::MultipartParser parser(BOUNDARY, recorded);
+            std::string body = "--" + BOUNDARY + "\r\n\r\nsome content\r\n--" + BOUNDARY;
+            CHECK(parser.feed(body.data(), body.size()));
+            CHECK(!parser.is_finished());
+            CHECK(recorded.contents[0] == "some content");
+        }
+        SECTION("anything but whitespace behind a boundary is malformed"){
+            RecordedParts recorded;
+            HTTPRequest::MultipartParser parser(BOUNDARY, recorded);
+            std::string body = "--" + BOUNDARY + "x\r\n\r\ncontent\r\n--" + BOUNDARY + "--";
+            CHECK(!parser.feed(body.data(), body.size()));
+            CHECK(parser.is_failed());
+            CHECK(recorded.parts.empty());
+        }
+        SECTION("the delegate can stop the parser"){
+            RecordedParts recorded;
+            recorded.accept = false;
+            HTTPRequest::MultipartParser parser(BOUNDARY, recorded);
+            std::string body = form_body();
+            CHECK(!parser.feed(body.data(), body.size()));
+            CHECK(recorded.parts.size() == 1);
+        }
+    }
+}
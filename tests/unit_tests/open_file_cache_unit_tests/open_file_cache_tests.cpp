@@ -0,0 +1,55 @@
+#include "../catch_amalgamated.hpp"
+
+#include <string>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../../../src/Utility/OpenFileCache.hpp"
+
+namespace tests {
+    static void write_file(const std::string& path, const std::string& content) {
+        std::ofstream file(path.c_str());
+        file << content;
+    }
+
+    TEST_CASE ("Open file cache", "[open_file_cache]") {
+        std::string path = "/tmp/open_file_cache_test_" + std::to_string(getpid());
+        std::remove(path.c_str());
+        Utility::OpenFileCache::configure(2, 60);
+
+        SECTION("a cached file keeps its size until it is invalidated"){
+            write_file(path, "abc");
+            Utility::OpenFileCache::Info info;
+            int fd = Utility::OpenFileCache::open(path, info);
+            REQUIRE(fd != -1);
+            CHECK(info.size == 3);
+            CHECK(S_ISREG(info.mode));
+            close(fd);
+            write_file(path, "abcdef");
+            CHECK(Utility::OpenFileCache::lookup(path).size == 3);
+            Utility::OpenFileCache::invalidate(path);
+            CHECK(Utility::OpenFileCache::lookup(path).size == 6);
+        }
+        SECTION("missing paths are cached as well"){
+            CHECK(Utility::OpenFileCache::lookup(path).error == ENOENT);
+            write_file(path, "abc");
+            CHECK(Utility::OpenFileCache::lookup(path).error == ENOENT);
+            Utility::OpenFileCache::invalidate(path);
+            CHECK(Utility::OpenFileCache::lookup(path).error == 0);
+        }
+        SECTION("directories have no fd, the least recently used entry goes first"){
+            Utility::OpenFileCache::Info info;
+            CHECK(Utility::OpenFileCache::open("/tmp", info) == -1);
+            CHECK(S_ISDIR(info.mode));
+            Utility::OpenFileCache::lookup("/");
+            Utility::OpenFileCache::lookup(path);
+            CHECK(Utility::OpenFileCache::size() == 2);
+        }
+        Utility::OpenFileCache::configure(0, 60);
+        CHECK(Utility::OpenFileCache::size() == 0);
+        std::remove(path.c_str());
+    }
+}
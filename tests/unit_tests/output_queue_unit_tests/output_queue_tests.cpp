@@ -0,0 +1,172 @@
+#include "../catch_amalgamated.hpp"
+
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <zlib.h>
+
+#include "../../../src/HTTP/OutputQueue.hpp"
+#include "../../../src/Constants.hpp"
+
+namespace tests {
+    // a socket that takes at most capacity bytes per call and remembers what it got
+    class FakeSocket : public HTTP::RequestHandlerDelegate {
+    public:
+        FakeSocket(size_t capacity) : capacity(capacity), calls(0), closed(false) {}
+
+        size_t capacity;
+        int calls;
+        bool closed;
+        std::string received;
+
+        virtual size_t receive(char *, size_t) { return 0; }
+        virtual ssize_t send(const struct iovec *iov, int iov_count) {
+            calls++;
+            size_t sent = 0;
+            for (int i = 0; i < iov_count && sent < capacity; i++) {
+                size_t length = std::min(iov[i].iov_len, capacity - sent);
+                received.append(static_cast<const char *>(iov[i].iov_base), length);
+                sent += length;
+            }
+            return sent;
+        }
+        virtual ssize_t send_file(int file_fd, off_t& offset, size_t count) {
+            calls++;
+            char buffer[256];
+            ssize_t bytes_read = pread(file_fd, buffer, std::min(std::min(count, capacity), sizeof(buffer)), offset);
+            received.append(buffer, bytes_read);
+            offset += bytes_read;
+            return bytes_read;
+        }
+        virtual int get_fd() { return -1; }
+        virtual void close() { closed = true; }
+    };
+
+    static int temporary_file(const std::string& content) {
+        char path[] = "/tmp/output_queue_testXXXXXX";
+        int fd = mkstemp(path);
+        unlink(path);
+        write(fd, content.data(), content.size());
+        return fd;
+    }
+
+    // the data of a chunked body, inflated
+    static std::string gunzip_chunked(const std::string& body) {
+        std::string compressed;
+        size_t position = 0;
+        while (true) {
+            size_t line_end = body.find("\r\n", position);
+            size_t size = std::strtoul(body.substr(position, line_end - position).c_str(), NULL, 16);
+            position = line_end + 2;
+            if (size == 0)
+                break;
+            compressed.append(body, position, size);
+            position += size + 2;
+        }
+        std::string inflated(1 << 20, '\0');
+        uLongf length = inflated.size();
+        z_stream stream = z_stream();
+        inflateInit2(&stream, MAX_WBITS + 16);
+        stream.next_in = reinterpret_cast<Bytef *>(&compressed[0]);
+        stream.avail_in = compressed.size();
+        stream.next_out = reinterpret_cast<Bytef *>(&inflated[0]);
+        stream.avail_out = length;
+        inflate(&stream, Z_FINISH);
+        inflated.resize(stream.total_out);
+        inflateEnd(&stream);
+        return inflated;
+    }
+
+    TEST_CASE ("Output queue", "[output_queue]") {
+        HTTP::OutputQueue queue;
+
+        SECTION("consecutive memory segments go out in one call"){
+            FakeSocket socket(1000);
+            std::string first = "HTTP/1.1 200 OK\r\n\r\n";
+            std::string second = "hello";
+            queue.push_data(first);
+            queue.push_data(second);
+            CHECK(first.empty());
+            CHECK(queue.size() == 2);
+            CHECK(queue.flush(socket));
+            CHECK(socket.calls == 1);
+            CHECK(socket.received == "HTTP/1.1 200 OK\r\n\r\nhello");
+            CHECK(queue.empty());
+        }
+        SECTION("a partial send keeps the rest for the next flush"){
+            FakeSocket socket(4);
+            std::string first = "abcdef";
+            std::string second = "ghij";
+            queue.push_data(first);
+            queue.push_data(second);
+            CHECK(queue.flush(socket));
+            CHECK(socket.received == "abcd");
+            CHECK(queue.size() == 2);
+            CHECK(queue.flush(socket));
+            CHECK(socket.received == "abcdefgh");
+            CHECK(queue.size() == 1);
+            CHECK(queue.flush(socket));
+            CHECK(socket.received == "abcdefghij");
+            CHECK(queue.empty());
+        }
+        SECTION("file ranges are sent in order with the memory around them"){
+            FakeSocket socket(1000);
+            std::string head = "head|";
+            std::string tail = "|tail";
+            queue.push_data(head);
+            queue.push_file(temporary_file("0123456789"), 2, 8);
+            queue.push_data(tail);
+            CHECK(queue.flush(socket));
+            CHECK(socket.received == "head|234567|tail");
+            CHECK(queue.empty());
+        }
+        SECTION("a gzip file goes out in chunks, piece by piece"){
+            FakeSocket socket(1000);
+            std::string content;
+            for (int i = 0; content.size() < 200000; i++)
+                content += "line " + std::string(i % 7 + 1, 'x') + "\n";
+            std::string tail = "|next response";
+            queue.push_gzip_file(temporary_file(content), 0, content.size(), 6);
+            queue.push_data(tail);
+            for (int i = 0; i < 1000 && !queue.empty(); i++)
+                CHECK(queue.flush(socket));
+            CHECK(queue.empty());
+            size_t end = socket.received.find("0\r\n\r\n|next response");
+            REQUIRE(end != std::string::npos);
+            CHECK(end + 19 == socket.received.size());
+            CHECK(gunzip_chunked(socket.received) == content);
+        }
+        SECTION("an empty gzip file still ends the stream and the body"){
+            FakeSocket socket(1000);
+            queue.push_gzip_file(temporary_file(""), 0, 0, 1);
+            CHECK(queue.flush(socket));
+            CHECK(queue.empty());
+            CHECK(gunzip_chunked(socket.received).empty());
+            CHECK(socket.received.compare(socket.received.size() - 5, 5, "0\r\n\r\n") == 0);
+        }
+        SECTION("the queue is full while it holds a file or too many unsent bytes"){
+            FakeSocket socket(Constants::OUTPUT_QUEUE_SIZE - 1);
+            std::string response(Constants::OUTPUT_QUEUE_SIZE - 1, 'a');
+            queue.push_data(response);
+            CHECK(!queue.is_full());
+            std::string last = "b";
+            queue.push_data(last);
+            CHECK(queue.is_full());
+            CHECK(queue.flush(socket));
+            CHECK(queue.size() == 1);
+            CHECK(!queue.is_full());
+            queue.push_file(temporary_file("abc"), 0, 3);
+            CHECK(queue.is_full());
+            CHECK(queue.flush(socket));
+            CHECK(queue.empty());
+            CHECK(!queue.is_full());
+        }
+        SECTION("empty segments are not queued"){
+            std::string empty;
+            queue.push_data(empty);
+            queue.push_file(temporary_file("abc"), 3, 3);
+            CHECK(queue.empty());
+        }
+    }
+}
@@ -2,10 +2,12 @@
 
 #include <string>
 #include <fstream>
+#include <sstream>
 #include <map>
 
 #include "../../../src/HTTP/RequestHandler.hpp"
 #include "../../../src/HTTP/Exceptions/RequestException.hpp"
+#include "../../../src/Utility/Utility.hpp"
 
 namespace tests {
 
@@ -60,7 +62,7 @@ namespace tests {
                 CHECK(_http_request_message.get_HTTP_version() == "HTTP/1.1");
                 
                     SECTION("Headers must be split by ':' and headers map must be filled") {
-                        CHECK(_http_request_message.get_headers().size() == 7);
+                        CHECK(_http_request_message.get_header_count() == 7);
                         CHECK(_http_request_message.get_header_value("ACCEPT_LANGUAGE") == "en-us");
                     }
 
@@ -77,7 +79,7 @@ namespace tests {
             HTTPRequest::RequestParser parser(&_http_request_message, &_http_response_message);
             char* buf = create_writable_buf(http_requests[1]);
             parser.parse_HTTP_request(buf, strlen(buf));
-            CHECK(_http_request_message.get_headers().size() == 0);            
+            CHECK(_http_request_message.get_header_count() == 0);            
             delete[] buf;
         }
 
@@ -109,7 +111,7 @@ namespace tests {
                 CHECK(_http_request_message.get_HTTP_version() == "HTTP/1.1");
                 
                     SECTION("Headers must be split by ':' and headers map must be filled") {
-                        CHECK(_http_request_message.get_headers().size() == 7);
+                        CHECK(_http_request_message.get_header_count() == 7);
                         CHECK(_http_request_message.get_header_value("ACCEPT_LANGUAGE") == "en-us");
                     }
 
@@ -156,6 +158,242 @@ namespace tests {
         }
     }
 
+    TEST_CASE ("Request Parser - pipelined requests", "[request_parser]") {
+        SECTION ("Parsing stops at the end of the first request and reports the consumed bytes", "[valid_request]") {
+            HTTPRequest::RequestMessage _http_request_message;
+            HTTPResponse::ResponseMessage _http_response_message;
+            HTTPRequest::RequestParser parser(&_http_request_message, &_http_response_message);
+            std::string first = "GET /first HTTP/1.1\r\nHost: localhost\r\n\r\n";
+            std::string second = "GET /second HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+            char* buf = create_writable_buf(first + second);
+            size_t consumed = parser.parse_HTTP_request(buf, strlen(buf));
+            CHECK(consumed == first.size());
+            CHECK(parser.is_parsing_finished());
+            CHECK(_http_request_message.get_uri().get_path().back() == "first");
+
+            _http_request_message.reset();
+            parser.reset();
+            CHECK(parser.parse_HTTP_request(buf + consumed, strlen(buf) - consumed) == second.size());
+            CHECK(parser.is_parsing_finished());
+            CHECK(_http_request_message.get_uri().get_path().back() == "second");
+            delete[] buf;
+        }
+        SECTION ("Payload is bounded by Content-Length, the next request is left untouched", "[valid_request]") {
+            HTTPRequest::RequestMessage _http_request_message;
+            HTTPResponse::ResponseMessage _http_response_message;
+            HTTPRequest::RequestParser parser(&_http_request_message, &_http_response_message);
+            std::string first = "POST /upload HTTP/1.1\r\nHost: localhost\r\nContent-Length: 5\r\n\r\nhello";
+            std::string second = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+            char* buf = create_writable_buf(first + second);
+            CHECK(parser.parse_HTTP_request(buf, strlen(buf)) == first.size());
+            CHECK(parser.is_parsing_finished());
+            CHECK(_http_request_message.get_message_body() == "hello");
+            delete[] buf;
+        }
+        SECTION ("The final CRLF of a chunked request is part of that request", "[valid_request]") {
+            HTTPRequest::RequestMessage _http_request_message;
+            HTTPResponse::ResponseMessage _http_response_message;
+            HTTPRequest::RequestParser parser(&_http_request_message, &_http_response_message);
+            std::string first = "POST /upload HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n4\r\nWiki\r\n0\r\n\r\n";
+            std::string second = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+            char* buf = create_writable_buf(first + second);
+            CHECK(parser.parse_HTTP_request(buf, strlen(buf)) == first.size());
+            CHECK(parser.is_parsing_finished());
+            CHECK(_http_request_message.get_message_body() == "Wiki");
+            delete[] buf;
+        }
+    }
+
+    TEST_CASE ("Request Parser - request split over two reads", "[request_parser]") {
+        std::string request = "POST /upload HTTP/1.1\r\nHost: localhost:8080\r\nTransfer-Encoding: chunked\r\n\r\n"
+                              "a;name=value\r\n0123456789\r\n1A\r\nabcdefghijklmnopqrstuvwxyz\r\n0\r\n\r\n";
+        char* buf = create_writable_buf(request + "GET / HTTP/1.1\r\n");
+
+        SECTION ("Every split point gives the same request, lines are put back together and hex sizes take both cases", "[valid_request]") {
+            for (size_t split = 1; split < request.size(); split++) {
+                HTTPRequest::RequestMessage _http_request_message;
+                HTTPResponse::ResponseMessage _http_response_message;
+                HTTPRequest::RequestParser parser(&_http_request_message, &_http_response_message);
+
+                CHECK(parser.parse_HTTP_request(buf, split) == split);
+                CHECK(parser.parse_HTTP_request(buf + split, strlen(buf) - split) == request.size() - split);
+                CHECK(parser.is_parsing_finished());
+                CHECK(_http_request_message.get_header_value("HOST") == "localhost:8080");
+                CHECK(_http_request_message.get_message_body() == "0123456789abcdefghijklmnopqrstuvwxyz");
+                CHECK(_http_request_message.get_header_value("CONTENT_LENGTH") == "36");
+            }
+        }
+        delete[] buf;
+    }
+
+    TEST_CASE ("Request Parser - header table", "[request_parser]") {
+        HTTPRequest::RequestMessage _http_request_message;
+        HTTPResponse::ResponseMessage _http_response_message;
+        HTTPRequest::RequestParser parser(&_http_request_message, &_http_response_message);
+
+        SECTION ("Known fields get their id whatever the case of the name, typed accessors give the parsed values", "[valid_request]") {
+            char* buf = create_writable_buf("POST /upload HTTP/1.1\r\nhOsT: example.com:8080\r\nCONTENT-length: 5\r\nConnection: Upgrade, Close\r\nX-Custom: a\r\nx-custom: b\r\n\r\nhello");
+            parser.parse_HTTP_request(buf, strlen(buf));
+            CHECK(parser.is_parsing_finished());
+            CHECK(_http_request_message.get_header_count() == 4);
+            CHECK(_http_request_message.get_header_value(HTTPRequest::HEADER_HOST) == "example.com:8080");
+            CHECK(_http_request_message.get_header_value("HOST") == "example.com:8080");
+            CHECK(_http_request_message.get_host_name().equals("example.com"));
+            CHECK(_http_request_message.get_content_length() == 5);
+            CHECK(_http_request_message.has_connection_option("close"));
+            CHECK(!_http_request_message.has_connection_option("keep-alive"));
+            CHECK(_http_request_message.get_header_value("X_CUSTOM") == "a, b");
+            CHECK(!_http_request_message.has_header_field(HTTPRequest::HEADER_RANGE));
+            CHECK(_http_request_message.get_header_value(HTTPRequest::HEADER_RANGE) == "");
+            delete[] buf;
+        }
+        SECTION ("A reset message starts with an empty table", "[valid_request]") {
+            char* buf = create_writable_buf("GET / HTTP/1.1\r\nHost: localhost\r\nRange: bytes=0-1\r\n\r\nGET / HTTP/1.1\r\nHost: other\r\n\r\n");
+            size_t consumed = parser.parse_HTTP_request(buf, strlen(buf));
+            _http_request_message.reset();
+            parser.reset();
+            parser.parse_HTTP_request(buf + consumed, strlen(buf) - consumed);
+            CHECK(_http_request_message.get_header_count() == 1);
+            CHECK(!_http_request_message.has_header_field(HTTPRequest::HEADER_RANGE));
+            CHECK(_http_request_message.get_header_value(HTTPRequest::HEADER_HOST) == "other");
+            CHECK(_http_request_message.get_content_length() == -1);
+            delete[] buf;
+        }
+    }
+
+    TEST_CASE ("Request Parser - multipart body", "[request_parser]") {
+        HTTPRequest::RequestMessage _http_request_message;
+        HTTPResponse::ResponseMessage _http_response_message;
+        HTTPRequest::RequestParser parser(&_http_request_message, &_http_response_message);
+
+        SECTION ("The body is kept as it is, chunked or not, its boundary comes with the message", "[valid_request]") {
+            std::string body = "--xyz\r\nContent-Disposition: form-data; name=\"f\"; filename=\"f.txt\"\r\n\r\ndata\r\n--xyz--\r\n";
+            std::ostringstream chunk_size;
+            chunk_size << std::hex << body.size();
+            std::string request = "POST /upload HTTP/1.1\r\nHost: localhost\r\nContent-Type: multipart/form-data; boundary=\"xyz\"\r\nTransfer-Encoding: chunked\r\n\r\n"
+                + chunk_size.str() + "\r\n" + body + "\r\n0\r\n\r\n";
+            parser.parse_HTTP_request(&request[0], request.size());
+            CHECK(parser.is_parsing_finished());
+            CHECK(_http_request_message.get_multipart_boundary() == "xyz");
+            CHECK(_http_request_message.get_message_body() == body);
+        }
+        SECTION ("Multipart without a boundary, Bad Request must be thrown", "[invalid_request]") {
+            std::string request = "POST /upload HTTP/1.1\r\nHost: localhost\r\nContent-Type: multipart/form-data\r\nContent-Length: 4\r\n\r\ndata";
+            CHECK_THROWS_AS(parser.parse_HTTP_request(&request[0], request.size()), ::Exception::RequestException);
+        }
+    }
+
+    // the limits a server block would give
+    class TestLimits : public HTTPRequest::RequestParserDelegate {
+    public:
+        HTTPRequest::BodyLimits limits;
+
+        TestLimits(long max_size, long buffer_size) {
+            limits.max_size = max_size;
+            limits.buffer_size = buffer_size;
+        }
+        HTTPRequest::BodyLimits get_body_limits() {
+            return limits;
+        }
+    };
+
+    TEST_CASE ("Request Parser - body limits", "[request_parser]") {
+        HTTPRequest::RequestMessage _http_request_message;
+        HTTPResponse::ResponseMessage _http_response_message;
+        HTTPRequest::RequestParser parser(&_http_request_message, &_http_response_message);
+        TestLimits limits(100, 8);
+        parser.set_delegate(&limits);
+
+        SECTION ("A body bigger than the buffer size goes to a temporary file, a smaller one stays in memory", "[valid_request]") {
+            char* buf = create_writable_buf("POST /upload HTTP/1.1\r\nHost: localhost\r\nContent-Length: 12\r\n\r\nhello world!");
+            parser.parse_HTTP_request(buf, 60);
+            parser.parse_HTTP_request(buf + 60, strlen(buf) - 60);
+            CHECK(parser.is_parsing_finished());
+            CHECK(_http_request_message.get_payload_fd() != -1);
+            CHECK(_http_request_message.get_payload_size() == 12);
+            CHECK(_http_request_message.get_message_body().empty());
+            char tail[6];
+            CHECK(_http_request_message.read_payload(6, tail, sizeof(tail)) == 6);
+            CHECK(std::string(tail, 6) == "world!");
+            std::ostringstream body;
+            CHECK(_http_request_message.write_payload(body));
+            CHECK(body.str() == "hello world!");
+            delete[] buf;
+
+            _http_request_message.reset();
+            parser.reset();
+            buf = create_writable_buf("POST /upload HTTP/1.1\r\nHost: localhost\r\nContent-Length: 5\r\n\r\nhello");
+            parser.parse_HTTP_request(buf, strlen(buf));
+            CHECK(_http_request_message.get_payload_fd() == -1);
+            CHECK(_http_request_message.get_message_body() == "hello");
+            delete[] buf;
+        }
+        SECTION ("A chunked body is spilled in the same way", "[valid_request]") {
+            char* buf = create_writable_buf("POST /upload HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n7\r\n world!\r\n0\r\n\r\n");
+            parser.parse_HTTP_request(buf, strlen(buf));
+            CHECK(parser.is_parsing_finished());
+            CHECK(_http_request_message.get_payload_fd() != -1);
+            CHECK(_http_request_message.get_content_length() == 12);
+            std::ostringstream body;
+            _http_request_message.write_payload(body);
+            CHECK(body.str() == "hello world!");
+            delete[] buf;
+        }
+        SECTION ("A body over the maximum is refused before it is read", "[invalid_request]") {
+            char* buf = create_writable_buf("POST /upload HTTP/1.1\r\nHost: localhost\r\nContent-Length: 101\r\n\r\n");
+            try {
+                parser.parse_HTTP_request(buf, strlen(buf));
+                FAIL("no exception");
+            }
+            catch (const ::Exception::RequestException& e) {
+                CHECK(e.get_error_status_code() == HTTPResponse::ContentTooLarge);
+            }
+            delete[] buf;
+        }
+        SECTION ("So are chunks that add up to more than the maximum", "[invalid_request]") {
+            char* buf = create_writable_buf("POST /upload HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n32\r\n");
+            parser.parse_HTTP_request(buf, strlen(buf));
+            std::string chunk(50, 'a');
+            chunk += "\r\n33\r\n";
+            try {
+                parser.parse_HTTP_request(&chunk[0], chunk.size());
+                FAIL("no exception");
+            }
+            catch (const ::Exception::RequestException& e) {
+                CHECK(e.get_error_status_code() == HTTPResponse::ContentTooLarge);
+            }
+            delete[] buf;
+        }
+        SECTION ("A header field longer than a line may be, the request ends there", "[invalid_request]") {
+            std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nX-Field: " + std::string(Constants::MAX_LINE_LENGTH, 'a');
+            try {
+                parser.parse_HTTP_request(&request[0], request.size());
+                FAIL("no exception");
+            }
+            catch (const ::Exception::RequestException& e) {
+                CHECK(e.get_error_status_code() == HTTPResponse::RequestHeaderFieldsTooLarge);
+            }
+            CHECK(parser.is_parsing_finished());
+        }
+        SECTION ("Too many header fields", "[invalid_request]") {
+            std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\n";
+            for (int i = 0; i < Constants::MAX_HEADER_FIELDS; i++) {
+                request += "X-Field-" + Utility::to_string(i) + ": value\r\n"; // fields of the same name would be combined
+            }
+            request += "\r\n";
+            try {
+                parser.parse_HTTP_request(&request[0], request.size());
+                FAIL("no exception");
+            }
+            catch (const ::Exception::RequestException& e) {
+                CHECK(e.get_error_status_code() == HTTPResponse::RequestHeaderFieldsTooLarge);
+            }
+        }
+    }
+
     TEST_CASE ("Invalid requests - exceptions thrown", "[request_parser]") {
         std::vector<std::string> http_requests = fill_requests("request_parser_unit_tests/request_parser_messages_to_throw_exceptions.txt");
         SECTION ("Space between header field and colon not allowed, Bad Request must be thrown", "[invalid_request]") {
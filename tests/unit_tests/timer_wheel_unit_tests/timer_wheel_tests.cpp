@@ -0,0 +1,71 @@
+#include "../catch_amalgamated.hpp"
+
+#include <vector>
+
+#include "../../../src/Utility/TimerWheel.hpp"
+
+namespace tests {
+    // advances one second at a time and returns the second at which the timer expired, -1 if it did not
+    static time_t expiry_second(Utility::TimerWheel& wheel, time_t from, time_t to, int id) {
+        for (time_t now = from; now <= to; now++) {
+            std::vector<Utility::TimerWheel::Timer*> expired;
+            wheel.advance(now, expired);
+            for (size_t i = 0; i < expired.size(); i++) {
+                if (expired[i]->id == id)
+                    return now;
+            }
+        }
+        return -1;
+    }
+
+    TEST_CASE ("Timer wheel", "[timer_wheel]") {
+        Utility::TimerWheel wheel(1000);
+        Utility::TimerWheel::Timer timer;
+        timer.id = 7;
+
+        SECTION("a timer expires on its second, on every level of the wheel"){
+            time_t delays[] = {1, 5, 63, 64, 65, 75, 4095, 4096, 4100, 300000};
+            time_t start = 1000;
+            for (size_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+                wheel.schedule(timer, start + delays[i]);
+                CHECK(expiry_second(wheel, start, start + delays[i] + 1, 7) == start + delays[i]);
+                CHECK(!timer.is_scheduled());
+                start += delays[i];
+            }
+        }
+        SECTION("advancing over several seconds at once collects everything that expired"){
+            Utility::TimerWheel::Timer timers[3];
+            for (int i = 0; i < 3; i++) {
+                timers[i].id = i;
+                wheel.schedule(timers[i], 1000 + 10 * (i + 1)); // 1010, 1020, 1030
+            }
+            std::vector<Utility::TimerWheel::Timer*> expired;
+            wheel.advance(1025, expired);
+            CHECK(expired.size() == 2);
+            CHECK(wheel.size() == 1);
+            wheel.cancel(timers[2]);
+        }
+        SECTION("rescheduling moves the expiry, cancelling removes the timer"){
+            wheel.schedule(timer, 1010);
+            wheel.schedule(timer, 1100);
+            CHECK(wheel.size() == 1);
+            CHECK(expiry_second(wheel, 1000, 1200, 7) == 1100);
+            wheel.schedule(timer, 1300);
+            wheel.cancel(timer);
+            CHECK(wheel.size() == 0);
+            CHECK(expiry_second(wheel, 1200, 1400, 7) == -1);
+        }
+        SECTION("a timer in the past expires with the next second"){
+            wheel.schedule(timer, 900);
+            CHECK(expiry_second(wheel, 1000, 1005, 7) == 1001);
+        }
+        SECTION("the wait timeout follows the next expiry, at least up to the next move of a higher level"){
+            CHECK(wheel.next_timeout() == -1);
+            wheel.schedule(timer, 1005);
+            CHECK(wheel.next_timeout() == 5);
+            wheel.schedule(timer, 1500);
+            CHECK(wheel.next_timeout() == 24); // 1024 is the next multiple of 64
+            wheel.cancel(timer);
+        }
+    }
+}